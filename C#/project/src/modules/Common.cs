@@ -26,7 +26,8 @@ public enum UploadStatus
     SDK_INIT_SUCCESS = 5,
     SDK_CLEAN_SUCCESS = 6,
     CONFIRM_SUCCESS = 7,
-    CONFIRM_FAILED = 8
+    CONFIRM_FAILED = 8,
+    UPLOAD_QUEUED_DEFERRED = 9
 }
 
 /// <summary>
@@ -144,7 +145,9 @@ public enum FileOperationType
                 if (root.TryGetProperty("code", out var codeElement))
                 {
                     var startCode = codeElement.GetInt64();
-                    if (startCode != (long)UploadStatus.UPLOAD_SUCCESS)
+                    // UPLOAD_QUEUED_DEFERRED means accepted and parked until upload budget frees up
+                    if (startCode != (long)UploadStatus.UPLOAD_SUCCESS &&
+                        startCode != (long)UploadStatus.UPLOAD_QUEUED_DEFERRED)
                     {
                         var message = root.TryGetProperty("message", out var msgElement) ? msgElement.GetString()
                                                                                          : "Unknown error";
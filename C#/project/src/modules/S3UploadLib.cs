@@ -51,6 +51,380 @@ public static class S3UploadLib
                                                                   SizeParamIndex = 2)] byte[] buffer,
                                                        int bufferSize);
 
+    /// <summary>
+    /// Start asynchronous upload to S3 and return a compact upload handle
+    /// Return value: upload handle (&gt; 0) on success, 0 on failure
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern long UploadFileAsyncHandle([MarshalAs(UnmanagedType.LPStr)] string region,
+                                                    [MarshalAs(UnmanagedType.LPStr)] string bucketName,
+                                                    [MarshalAs(UnmanagedType.LPStr)] string objectKey,
+                                                    [MarshalAs(UnmanagedType.LPStr)] string localFilePath,
+                                                    [MarshalAs(UnmanagedType.LPStr)] string dataId,
+                                                    [MarshalAs(UnmanagedType.LPStr)] string patientId,
+                                                    int fileOperationType);
+
+    /// <summary>
+    /// Get the status of a single upload by handle
+    /// Return value: UploadStatus value, -1 if the handle is unknown or stale
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int GetUploadStatusByHandle(long handle);
+
+    /// <summary>
+    /// Request cancellation of a queued or running upload
+    /// Return value: 1 if cancellation was requested, 0 if unknown or already finished
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int CancelAsyncUpload([MarshalAs(UnmanagedType.LPStr)] string uploadId);
+
+    /// <summary>
+    /// Request cancellation of a queued or running upload by handle
+    /// Return value: 1 if cancellation was requested, 0 if unknown or already finished
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int CancelAsyncUploadByHandle(long handle);
+
+    /// <summary>
+    /// Configure upload admission control (budget of queued and transferring uploads)
+    /// Parameters:
+    ///   highWatermarkMB / lowWatermarkMB: stop admitting above the high mark, resume at the low mark
+    ///   highWatermarkTasks / lowWatermarkTasks: same for the number of uploads
+    ///   policy: 0 = reject, 1 = block up to blockTimeoutMs, 2 = accept as UPLOAD_QUEUED_DEFERRED
+    /// Return value: 1 on success, 0 if the parameters are invalid
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int ConfigureUploadAdmission(int highWatermarkMB, int lowWatermarkMB,
+                                                      int highWatermarkTasks, int lowWatermarkTasks,
+                                                      int policy, int blockTimeoutMs);
+
+    /// <summary>
+    /// Enable the upload journal so queued uploads survive a crash or restart
+    /// Parameters:
+    ///   directory: folder for upload_journal.log (null or empty disables the journal)
+    /// Unfinished uploads from a previous run are re-enqueued with their original uploadId
+    /// once SetCredential has been called
+    /// Return value: 1 on success, 0 if the journal file cannot be opened
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int EnableUploadJournal(string directory);
+
+    /// <summary>
+    /// Get only the uploads of a dataId that changed after sinceVersion
+    /// Parameters:
+    ///   dataId: Data ID used to identify the upload
+    ///   sinceVersion: "version" from the previous response (0 = full list)
+    ///   buffer: Byte array to receive the JSON (null with bufferSize 0 to query the size)
+    ///   bufferSize: Size of the buffer
+    /// The JSON has the summary fields of GetAsyncUploadStatusBytes plus "version" and
+    /// "full" (true when "uploads" lists every upload rather than just the changed ones)
+    /// Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+    /// (if it did not fit, call again with the same sinceVersion and a larger buffer)
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int GetAsyncUploadStatusDelta([MarshalAs(UnmanagedType.LPStr)] string dataId,
+                                                       long sinceVersion,
+                                                       [MarshalAs(UnmanagedType.LPArray,
+                                                                  SizeParamIndex = 3)] byte[] buffer,
+                                                       int bufferSize);
+
+    /// <summary>
+    /// Block until an upload of a dataId changes state, all of its uploads are finished,
+    /// or the timeout elapses (long-poll alternative to polling GetAsyncUploadStatusBytes)
+    /// Parameters:
+    ///   dataId: Data ID used to identify the upload
+    ///   sinceVersion: newVersion from the previous call, or "version" from GetAsyncUploadStatusDelta
+    ///                 (0 = return the current version immediately)
+    ///   timeoutMs: Maximum time to wait in milliseconds
+    ///   newVersion: Receives the current status version
+    /// Return value: 1 = changed, 2 = all uploads finished, 0 = timeout, -1 = unknown dataId
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int WaitForUploadStatusChange([MarshalAs(UnmanagedType.LPStr)] string dataId,
+                                                       long sinceVersion, int timeoutMs,
+                                                       out long newVersion);
+
+    /// <summary>
+    /// Callback invoked on upload state transitions (notificationType 0) and progress
+    /// milestones (notificationType 1). Runs on the library's notification thread.
+    /// Keep a reference to the delegate for as long as it is registered.
+    /// </summary>
+    [UnmanagedFunctionPointer(CallingConvention.StdCall)]
+    public delegate void UploadNotificationCallback(int notificationType, IntPtr uploadId, IntPtr dataId,
+                                                    int status, long bytesTransferred, long totalBytes,
+                                                    IntPtr userData);
+
+    /// <summary>
+    /// Register a callback for upload notifications (null to unregister)
+    /// Return value: 1
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int RegisterUploadCallback(UploadNotificationCallback callback, IntPtr userData);
+
+    /// <summary>
+    /// Register a window that receives PostMessage(hwnd, message, notificationType, status)
+    /// for every upload notification (IntPtr.Zero to unregister)
+    /// Return value: 1
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int RegisterUploadWindowMessage(IntPtr hwnd, uint message);
+
+    /// <summary>
+    /// Register an event (e.g. AutoResetEvent.SafeWaitHandle) that is set for every upload
+    /// notification (IntPtr.Zero to unregister); the library keeps its own duplicate
+    /// Return value: 1 on success, 0 if the handle is invalid
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int RegisterUploadEvent(IntPtr eventHandle);
+
+    /// <summary>
+    /// Group header of the binary status format (96 bytes)
+    /// Strings are NUL-terminated ANSI strings at stringTableOffset + the given offset
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack = 4)]
+    public struct UploadStatusBinaryHeader
+    {
+        public uint magic;              // 0x53555048 ("HPUS")
+        public ushort formatVersion;
+        public ushort headerSize;
+        public uint recordSize;
+        public int code;
+        public int overallStatus;
+        public int uploadCount;
+        public int uploadedCount;
+        public uint stringTableOffset;
+        public uint stringTableSize;
+        public int dataIdOffset;
+        public int errorMessageOffset;
+        public int reserved;
+        public long uploadedSize;
+        public long totalSize;
+        public long statusVersion;
+        public long bytesSent;          // formatVersion >= 2
+        public long bytesPerSecond;
+        public long etaSeconds;         // -1 = unknown
+    }
+
+    /// <summary>
+    /// Per-upload record of the binary status format (88 bytes)
+    /// flags: 1 = coalesced into an earlier REAL_TIME_APPEND upload
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack = 4)]
+    public struct UploadStatusBinaryRecord
+    {
+        public int status;
+        public int flags;
+        public long totalSize;
+        public long startTimeMs;
+        public long endTimeMs;
+        public long statusVersion;
+        public long handle;
+        public int uploadIdOffset;
+        public int localFilePathOffset;
+        public int s3ObjectKeyOffset;
+        public int errorMessageOffset;
+        public long bytesSent;          // formatVersion >= 2
+        public long bytesPerSecond;
+        public long etaSeconds;         // -1 = unknown
+    }
+
+    /// <summary>
+    /// Get upload status as a header, fixed-size records and a string table (no JSON parsing)
+    /// Parameters:
+    ///   dataId: Data ID used to identify the upload
+    ///   buffer: Byte array to receive the data (null with bufferSize 0 to query the size)
+    ///   bufferSize: Size of the buffer
+    /// Records start at headerSize and are recordSize bytes apart
+    /// Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int GetAsyncUploadStatusBinary([MarshalAs(UnmanagedType.LPStr)] string dataId,
+                                                        [MarshalAs(UnmanagedType.LPArray,
+                                                                   SizeParamIndex = 2)] byte[] buffer,
+                                                        int bufferSize);
+
+    /// <summary>
+    /// Get the status of many dataIds in one call
+    /// Parameters:
+    ///   dataIds: Comma-separated list of data IDs
+    ///   includeUploads: Non-zero to include the per-upload list of every dataId
+    ///   buffer: Byte array to receive the JSON (null with bufferSize 0 to query the size)
+    ///   bufferSize: Size of the buffer
+    /// Response: {"code":2,"results":[...]} with one status object per dataId, in request order
+    /// Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int GetAsyncUploadStatusBatch([MarshalAs(UnmanagedType.LPStr)] string dataIds,
+                                                       int includeUploads,
+                                                       [MarshalAs(UnmanagedType.LPArray,
+                                                                  SizeParamIndex = 3)] byte[] buffer,
+                                                       int bufferSize);
+
+    /// <summary>
+    /// Get the buffer size GetAsyncUploadStatusBytes needs for the complete status JSON
+    /// Parameters:
+    ///   dataId: Data ID used to identify the upload
+    /// Return value: Number of bytes required, 0 on error
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int GetAsyncUploadStatusRequiredSize([MarshalAs(UnmanagedType.LPStr)] string dataId);
+
+    /// <summary>
+    /// Get one page of the upload status of a dataId (valid JSON per page)
+    /// Parameters:
+    ///   dataId: Data ID used to identify the upload
+    ///   offset: Index of the first upload to return
+    ///   limit: Maximum number of uploads to return (0 for all remaining)
+    ///   buffer: Byte array to receive the JSON (null with bufferSize 0 to query the size)
+    ///   bufferSize: Size of the buffer
+    /// Response: summary fields plus "version", "membershipVersion", "offset", "limit", "nextOffset" (-1 after the last page) and "uploads"
+    /// Restart paging at offset 0 if "membershipVersion" differs between pages (uploads were added or removed)
+    /// Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int GetAsyncUploadStatusPage([MarshalAs(UnmanagedType.LPStr)] string dataId,
+                                                      int offset,
+                                                      int limit,
+                                                      [MarshalAs(UnmanagedType.LPArray,
+                                                                 SizeParamIndex = 4)] byte[] buffer,
+                                                      int bufferSize);
+
+    /// <summary>
+    /// Header of the shared-memory status board (64 bytes)
+    /// Copy header and slots through their seqlocks, or use ReadUploadStatusBoard
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack = 4)]
+    public struct UploadStatusBoardHeader
+    {
+        public uint magic;              // 0x42535048 ("HPSB")
+        public ushort formatVersion;
+        public ushort headerSize;
+        public uint slotSize;
+        public uint slotCount;
+        public uint ownerProcessId;
+        public int state;               // 0 = closed, 1 = active
+        public uint sequence;           // Changes after every update
+        public uint usedSlots;
+        public uint droppedUploads;
+        public uint reserved;
+        public long updateTimeMs;       // Unix epoch milliseconds
+        public long reserved2;
+        public long reserved3;
+    }
+
+    /// <summary>
+    /// One upload slot of the shared-memory status board (320 bytes)
+    /// inUse: 0 = free slot; strings are NUL-terminated ANSI
+    /// </summary>
+    [StructLayout(LayoutKind.Sequential, Pack = 4, CharSet = CharSet.Ansi)]
+    public struct UploadStatusBoardSlot
+    {
+        public uint sequence;
+        public int inUse;
+        public int status;
+        public int flags;
+        public long handle;
+        public long totalSize;
+        public long bytesSent;
+        public long bytesPerSecond;
+        public long etaSeconds;         // -1 = unknown
+        public long statusVersion;
+        public long updateTimeMs;       // Unix epoch milliseconds
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 80)] public string uploadId;
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 64)] public string dataId;
+        [MarshalAs(UnmanagedType.ByValTStr, SizeConst = 104)] public string fileName;
+    }
+
+    /// <summary>
+    /// Publish upload status to a named shared-memory board for other processes
+    /// Parameters:
+    ///   name: Mapping name (null for "Local\HippoUploadStatusBoard")
+    ///   slotCount: Number of upload slots (0 for 1024)
+    /// Return value: 1 on success, 0 if the board cannot be created
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int EnableUploadStatusBoard([MarshalAs(UnmanagedType.LPStr)] string name, int slotCount);
+
+    /// <summary>
+    /// Stop publishing to the status board
+    /// Return value: 1
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int DisableUploadStatusBoard();
+
+    /// <summary>
+    /// Copy a status board published by this or another process
+    /// Parameters:
+    ///   name: Mapping name (null for the default name)
+    ///   buffer: Byte array to receive header and slots (null with bufferSize 0 to query the size)
+    ///   bufferSize: Size of the buffer
+    /// Slots start at headerSize and are slotSize bytes apart
+    /// Return value: Number of bytes required; data is copied only if it fits, 0 if no board exists
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int ReadUploadStatusBoard([MarshalAs(UnmanagedType.LPStr)] string name,
+                                                   [MarshalAs(UnmanagedType.LPArray,
+                                                              SizeParamIndex = 2)] byte[] buffer,
+                                                   int bufferSize);
+
+    /// <summary>
+    /// Configure background renewal of cached S3 credentials
+    /// Parameters:
+    ///   lifetimePercent: renew once this percentage of the credential lifetime has passed
+    ///                    (at the latest 5 minutes before expiry); 0 = renew only when an
+    ///                    upload finds them about to expire. Default: 75
+    /// Return value: 1 on success, 0 if lifetimePercent is outside 0..99
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int ConfigureCredentialRefresh(int lifetimePercent);
+
+    /// <summary>
+    /// Enable the warm-start credential cache
+    /// The JWT and unexpired S3 credentials are kept on disk, encrypted for the current
+    /// Windows user and account, so a restarted process skips login and the first
+    /// credential request per patient. Call before SetCredential
+    /// Parameters:
+    ///   directory: folder for the cache files (null or empty disables the cache)
+    /// Return value: 1 on success, 0 if the directory cannot be used
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern int EnableCredentialCache(string directory);
+
+    /// <summary>
+    /// Set credentials and initialize AWS SDK without blocking the caller
+    /// Initialization and login over a warmed-up connection to the Hippo API run in
+    /// the background. Uploads submitted meanwhile are accepted and start once the
+    /// credentials are set. Use PrewarmUploadTarget to also warm the S3 client
+    /// Return type: JSON string, code 0 once initialization has started
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern IntPtr SetCredentialAsync([MarshalAs(UnmanagedType.LPStr)] string hippoApiUrl,
+                                                   [MarshalAs(UnmanagedType.LPStr)] string userName,
+                                                   [MarshalAs(UnmanagedType.LPStr)] string password);
+
+    /// <summary>
+    /// Wait for the background initialization started by SetCredentialAsync
+    /// Parameters:
+    ///   timeoutMs: 0 polls, negative waits indefinitely
+    /// Return type: JSON string, code 0 while initialization is still running,
+    /// otherwise the same response as SetCredential
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall)]
+    public static extern IntPtr WaitForCredential(int timeoutMs);
+
+    /// <summary>
+    /// Prepare the first upload to a bucket ahead of time
+    /// In the background (once the credentials are set), fetches the patient's S3
+    /// credentials, creates the S3 client its uploads reuse and opens its connection
+    /// to the bucket endpoint
+    /// Return value: 1 if the warm-up was started, 0 on invalid parameters or if
+    /// neither SetCredential nor SetCredentialAsync was called
+    /// </summary>
+    [DllImport("S3UploadLib.dll", CallingConvention = CallingConvention.StdCall, CharSet = CharSet.Ansi)]
+    public static extern int PrewarmUploadTarget([MarshalAs(UnmanagedType.LPStr)] string region,
+                                                 [MarshalAs(UnmanagedType.LPStr)] string bucketName,
+                                                 [MarshalAs(UnmanagedType.LPStr)] string patientId);
+
     /// <summary>
     /// Helper method to convert IntPtr to string (for marshalling C-style strings)
     /// </summary>
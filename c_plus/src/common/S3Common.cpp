@@ -1,25 +1,39 @@
 #include "S3Common.h"
+#include "json_writer.h"
+#include "upload_status_binary.h"
+#include "request/s3_client_manager.h"
+#include <algorithm>
 
 // Global variables
-bool g_isInitialized = false;
+std::atomic<bool> g_isInitialized(false);
 Aws::SDKOptions g_options;
 
-// HippoClient credentials
-String g_apiUrl = "";
-String g_email = "";
-String g_password = "";
+// Background initialization (SetCredentialAsync)
+static std::mutex g_setCredentialMutex;                 // Serializes SetCredential and background initializations
+static std::mutex g_readinessMutex;                     // Protects the readiness state below
+static std::condition_variable g_readinessCondition;    // Signals the end of a background initialization
+static int g_pendingInitializations = 0;                // Background initializations not finished yet
+static String g_lastCredentialResult;                   // Response of the last finished SetCredential(Async)
+
+// Credentials of the last SetCredential(Async), written by ApplyCredential
+// Guarded by g_setCredentialMutex; other code reads them through HippoClient
+static String g_apiUrl;
+static String g_email;
+static String g_password;
 
 // Upload cleanup configuration
 // 3 days = 3 * 24 * 60 * 60 * 1000000 = 259200000000 microseconds
 static const long long THREE_DAYS_IN_MICROSECONDS = 259200000000LL;
 
 String create_response(int code, const String& message) {
-    std::ostringstream oss;
-    oss << "{"
-        << "\"code\":" << code << ","
-        << "\"message\":\"" << message << "\""
-        << "}";
-    return oss.str();
+    String response;
+    response.reserve(message.size() + 32);
+    JsonWriter json(response);
+    json.beginObject()
+        .field("code", code)
+        .field("message", message)
+        .endObject();
+    return response;
 }
 
 // Format error message helper function
@@ -35,6 +49,19 @@ String getUploadId(const String& dataId, long long timestamp) {
     return dataId + UPLOAD_ID_SEPARATOR + std::to_string(timestamp);
 }
 
+// Get local file size without opening the file
+// Uses the file attributes (directory metadata) instead of an open + seek
+long long QueryLocalFileSize(const String& filePath) {
+    WIN32_FILE_ATTRIBUTE_DATA attributes;
+    if (!GetFileAttributesExA(filePath.c_str(), GetFileExInfoStandard, &attributes)) {
+        return -1;
+    }
+    if (attributes.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) {
+        return -1;
+    }
+    return (static_cast<long long>(attributes.nFileSizeHigh) << 32) | attributes.nFileSizeLow;
+}
+
 // Extract uploadDataName from S3 objectKey
 // objectKey format: "patient/patientId/source_data/dataId/uploadDataName/" or 
 //                   "patient/patientId/source_data/dataId/uploadDataName/filename"
@@ -75,46 +102,67 @@ String extractFileName(const String& objectKey) {
     return fileName;
 }
 
+// Split uploadId ("dataId_timestamp") at the last separator
+bool splitUploadId(const String& uploadId, String& dataId, long long& timestamp) {
+    size_t separatorPos = uploadId.rfind(UPLOAD_ID_SEPARATOR);
+    if (separatorPos == String::npos || separatorPos + UPLOAD_ID_SEPARATOR.length() >= uploadId.length()) {
+        return false;
+    }
+
+    String timestampStr = uploadId.substr(separatorPos + UPLOAD_ID_SEPARATOR.length());
+    if (timestampStr.find_first_not_of("0123456789") != String::npos) {
+        return false;
+    }
+
+    try {
+        timestamp = std::stoll(timestampStr);
+    } catch (const std::exception&) {
+        return false;
+    }
+    dataId = uploadId.substr(0, separatorPos);
+    return true;
+}
+
 // AsyncUploadManager::addUpload implementation
 String AsyncUploadManager::addUpload(const String& uploadId, const String& localFilePath, const String& s3ObjectKey, const String& patientId, const String& region, const String& bucketName) {
     std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
     
-    // Step 1: Clean up uploads older than 3 days
+    // Step 1: Clean up uploads older than 3 days (live and archived)
     // Get current timestamp in microseconds
     auto nowTimePoint = std::chrono::high_resolution_clock::now();
     auto currentTimestampMicroseconds = std::chrono::duration_cast<std::chrono::microseconds>(nowTimePoint.time_since_epoch()).count();
     
     // Iterate through all uploads and remove those older than 3 days
-    std::vector<String> uploadsToRemove;
-    for (const auto& pair : uploads_) {
-        const String& existingUploadId = pair.first;
-        
-        // Extract timestamp from uploadId (format: "dataId_timestamp")
-        size_t separatorPos = existingUploadId.find(UPLOAD_ID_SEPARATOR);
-        if (separatorPos != String::npos && separatorPos < existingUploadId.length() - 1) {
-            String timestampStr = existingUploadId.substr(separatorPos + UPLOAD_ID_SEPARATOR.length());
-            try {
-                long long uploadTimestampMicroseconds = std::stoll(timestampStr);
-                
-                // Calculate time difference in microseconds
-                long long timeDiffMicroseconds = currentTimestampMicroseconds - uploadTimestampMicroseconds;
-                
-                // Check if upload is older than 3 days
-                if (timeDiffMicroseconds > THREE_DAYS_IN_MICROSECONDS) {
-                    uploadsToRemove.push_back(existingUploadId);
-                    AWS_LOGSTREAM_INFO("S3Upload", "Marking upload for cleanup (older than 3 days): " << existingUploadId);
-                }
-            } catch (const std::exception& e) {
+    std::vector<UploadHandle> uploadsToRemove;
+    uploadHandles_.forEach([&](UploadHandle handle, const UploadSlot& slot) {
+        long long uploadTimestampMicroseconds = 0;
+        if (slot.live) {
+            // Extract timestamp from uploadId (format: "dataId_timestamp")
+            String existingDataId;
+            if (!splitUploadId(slot.live->uploadId, existingDataId, uploadTimestampMicroseconds)) {
                 // If timestamp parsing fails, log warning but continue
-                AWS_LOGSTREAM_WARN("S3Upload", "Failed to parse timestamp from uploadId: " << existingUploadId << ", error: " << e.what());
+                AWS_LOGSTREAM_WARN("S3Upload", "Failed to parse timestamp from uploadId: " << slot.live->uploadId);
+                return;
+            }
+        } else {
+            uploadTimestampMicroseconds = slot.archived.uploadTimestamp;
+            if (uploadTimestampMicroseconds < 0) {
+                return;
             }
         }
-    }
+
+        // Calculate time difference in microseconds
+        long long timeDiffMicroseconds = currentTimestampMicroseconds - uploadTimestampMicroseconds;
+
+        // Check if upload is older than 3 days
+        if (timeDiffMicroseconds > THREE_DAYS_IN_MICROSECONDS) {
+            uploadsToRemove.push_back(handle);
+        }
+    });
     
     // Remove old uploads
-    for (const auto& uploadIdToRemove : uploadsToRemove) {
-        uploads_.erase(uploadIdToRemove);
-        AWS_LOGSTREAM_INFO("S3Upload", "Cleaned up old upload: " << uploadIdToRemove);
+    for (UploadHandle handleToRemove : uploadsToRemove) {
+        eraseUploadInternal(handleToRemove);
     }
     
     if (!uploadsToRemove.empty()) {
@@ -131,19 +179,523 @@ String AsyncUploadManager::addUpload(const String& uploadId, const String& local
     progress->bucketName = bucketName;
     
     // Extract dataId from uploadId (format: "dataId_timestamp")
-    size_t separatorPos = uploadId.find(UPLOAD_ID_SEPARATOR);
-    if (separatorPos != String::npos) {
-        progress->dataId = uploadId.substr(0, separatorPos);
+    long long uploadTimestamp = 0;
+    if (!splitUploadId(uploadId, progress->dataId, uploadTimestamp)) {
+        progress->dataId.clear();
     }
     
     // Extract uploadDataName from s3ObjectKey
     progress->uploadDataName = extractUploadDataName(s3ObjectKey);
     
     progress->status = UPLOAD_PENDING;  // Set to pending initially
+
+    // Replacing an existing record with the same uploadId invalidates its handle
+    auto existing = uploads_.find(uploadId);
+    if (existing != uploads_.end()) {
+        eraseUploadInternal(existing->second->handle);
+    }
+
+    UploadSlot slot;
+    slot.live = progress;
+    progress->handle = uploadHandles_.insert(slot);
     uploads_[uploadId] = progress;
+    dataIdUploads_[progress->dataId].push_back(progress->handle);
+    progress->statusVersion = bumpStatusVersionInternal(progress->dataId);
+    dataIdStatus_[progress->dataId].lastAdditionVersion = progress->statusVersion;
+    dataIdStatus_[progress->dataId].unfinishedUploads++;
+    publishStatusBoardInternal(*progress);
     return uploadId;
 }
 
+// Publish the current state of an upload to the status board
+void AsyncUploadManager::publishStatusBoardInternal(const FileUploadTaskInfo& progress) const {
+    UploadStatusBoard& board = UploadStatusBoard::getInstance();
+    if (!board.isEnabled()) {
+        return;
+    }
+    UploadTransferInfo transfer = getUploadTransferInfo(progress, std::chrono::steady_clock::now());
+    UploadStatusBoardEntry entry;
+    entry.handle = static_cast<long long>(progress.handle);
+    entry.status = progress.status;
+    entry.flags = progress.coalescedInto.empty() ? 0 : UPLOAD_RECORD_FLAG_COALESCED;
+    entry.totalSize = progress.totalSize;
+    entry.bytesSent = transfer.bytesSent;
+    entry.bytesPerSecond = transfer.bytesPerSecond;
+    entry.etaSeconds = transfer.etaSeconds;
+    entry.statusVersion = progress.statusVersion;
+    entry.finished = isFinalUploadStatus(progress.status);
+    entry.uploadId = progress.uploadId;
+    entry.dataId = progress.dataId;
+    entry.localFilePath = progress.localFilePath;
+    board.publish(entry);
+}
+
+// Publish every tracked upload to the status board
+void AsyncUploadManager::publishAllToStatusBoard() const {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    uploadHandles_.forEach([this](UploadHandle handle, const UploadSlot& slot) {
+        if (slot.live) {
+            publishStatusBoardInternal(*slot.live);
+        } else if (auto restored = resolveHandleInternal(handle)) {
+            publishStatusBoardInternal(*restored);
+        }
+    });
+}
+
+// Resolve a handle to a live task or a restored copy of an archived one
+std::shared_ptr<FileUploadTaskInfo> AsyncUploadManager::resolveHandleInternal(UploadHandle handle) const {
+    const UploadSlot* slot = uploadHandles_.get(handle);
+    if (!slot) {
+        return nullptr;
+    }
+    if (slot->live) {
+        return slot->live;
+    }
+    auto restored = archive_.restore(slot->archived);
+    restored->handle = handle;
+    return restored;
+}
+
+// Get the status of an upload by handle without materializing archived records
+bool AsyncUploadManager::getUploadStatusByHandle(UploadHandle handle, UploadStatus& status) const {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    const UploadSlot* slot = uploadHandles_.get(handle);
+    if (!slot) {
+        return false;
+    }
+    status = slot->live ? slot->live->status : static_cast<UploadStatus>(slot->archived.status);
+    return true;
+}
+
+// Remove an upload (live or archived) from every index
+void AsyncUploadManager::eraseUploadInternal(UploadHandle handle) {
+    UploadSlot* slot = uploadHandles_.get(handle);
+    if (!slot) {
+        return;
+    }
+
+    String dataId;
+    if (slot->live) {
+        dataId = slot->live->dataId;
+        trackFinishedInternal(dataId, slot->live->status, UPLOAD_CANCELLED);
+        if (slot->live->fileOperationType == REAL_TIME_APPEND) {
+            auto pending = pendingAppendUploads_.find(appendCoalesceKey(*slot->live));
+            if (pending != pendingAppendUploads_.end() && pending->second == slot->live->uploadId) {
+                pendingAppendUploads_.erase(pending);
+            }
+        }
+        // The task's budget would otherwise stay reserved forever
+        if (slot->live->admittedBytes >= 0) {
+            admission_.release(slot->live->admittedBytes);
+            slot->live->admittedBytes = -1;
+        }
+        uploads_.erase(slot->live->uploadId);
+    } else {
+        dataId = archive_.dataIdOf(slot->archived);
+        archive_.release(slot->archived);
+    }
+
+    auto group = dataIdUploads_.find(dataId);
+    if (group != dataIdUploads_.end()) {
+        auto& handles = group->second;
+        handles.erase(std::remove(handles.begin(), handles.end(), handle), handles.end());
+        if (handles.empty()) {
+            dataIdUploads_.erase(group);
+            dataIdStatus_.erase(dataId);
+        } else {
+            dataIdStatus_[dataId].lastRemovalVersion = bumpStatusVersionInternal(dataId);
+        }
+    }
+
+    uploadHandles_.erase(handle);
+    UploadStatusBoard::getInstance().remove(static_cast<long long>(handle));
+}
+
+// Update upload status and mirror it onto coalesced uploads
+void AsyncUploadManager::updateProgress(const String& uploadId, UploadStatus status, const String& error) {
+    std::vector<String> updatedIds;
+    String dataId;
+    long long totalSize = 0;
+    {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = uploads_.find(uploadId);
+        if (it == uploads_.end()) {
+            return;
+        }
+        FileUploadTaskInfo& progress = *it->second;
+        applyStatusInternal(progress, status, error, updatedIds);
+        dataId = progress.dataId;
+        totalSize = progress.totalSize;
+    }
+
+    // Journal the transitions (buffered, never waits for disk) and notify the host
+    // (queued for the notification thread, so this never runs host code)
+    for (const String& updatedId : updatedIds) {
+        UploadJournal::getInstance().recordState(updatedId, status);
+        UploadNotifier::getInstance().notifyStatus(updatedId, dataId, status, totalSize);
+    }
+}
+
+// Apply a status change to an upload and the uploads coalesced into it
+void AsyncUploadManager::applyStatusInternal(FileUploadTaskInfo& progress, UploadStatus status, const String& error,
+                                             std::vector<String>& updatedIds) {
+    // Merged uploads share the dataId, so one version covers them
+    unsigned long long version = bumpStatusVersionInternal(progress.dataId);
+    trackFinishedInternal(progress.dataId, progress.status, status);
+    progress.status = status;
+    progress.statusVersion = version;
+    if (!error.empty()) {
+        progress.errorMessage = error;
+    }
+    updatedIds.push_back(progress.uploadId);
+    publishStatusBoardInternal(progress);
+
+    // Once the worker has started a REAL_TIME_APPEND task, later submissions must upload again
+    // (a parked task has not read the file yet, so it still takes them)
+    if (status != UPLOAD_PENDING && status != UPLOAD_QUEUED_DEFERRED && progress.fileOperationType == REAL_TIME_APPEND) {
+        auto pending = pendingAppendUploads_.find(appendCoalesceKey(progress));
+        if (pending != pendingAppendUploads_.end() && pending->second == progress.uploadId) {
+            pendingAppendUploads_.erase(pending);
+        }
+    }
+
+    // Uploads merged into this one share its transfer and confirmation
+    for (const String& aliasId : progress.coalescedUploadIds) {
+        auto alias = uploads_.find(aliasId);
+        if (alias == uploads_.end() || alias->second->coalescedInto != progress.uploadId) {
+            continue;
+        }
+        FileUploadTaskInfo& aliasProgress = *alias->second;
+        trackFinishedInternal(aliasProgress.dataId, aliasProgress.status, status);
+        aliasProgress.status = status;
+        aliasProgress.statusVersion = version;
+        aliasProgress.totalSize = progress.totalSize;
+        aliasProgress.startTime = progress.startTime;
+        aliasProgress.endTime = progress.endTime;
+        if (!error.empty()) {
+            aliasProgress.errorMessage = error;
+        }
+        publishStatusBoardInternal(aliasProgress);
+        updatedIds.push_back(aliasId);
+    }
+}
+
+// Publish a throughput sample of a running transfer
+// Samples do not bump the status version, so waiters are only woken by state changes;
+// they advance the dataId's sample count instead, which invalidates its cached snapshot
+void AsyncUploadManager::updateTransferProgress(const String& uploadId, long long bytesSent,
+                                                long long bytesPerSecond, long long averageBytesPerSecond) {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    auto it = uploads_.find(uploadId);
+    if (it == uploads_.end()) {
+        return;
+    }
+    FileUploadTaskInfo& progress = *it->second;
+    auto now = std::chrono::steady_clock::now();
+    if (bytesSent != progress.bytesSent) {
+        progress.lastProgressTime = now;
+    }
+    progress.bytesSent = bytesSent;
+    progress.bytesPerSecond = bytesPerSecond;
+    progress.averageBytesPerSecond = averageBytesPerSecond;
+    publishStatusBoardInternal(progress);
+    // Merged uploads share the dataId, so one sample covers them
+    dataIdStatus_[progress.dataId].sampleCount++;
+
+    for (const String& aliasId : progress.coalescedUploadIds) {
+        auto alias = uploads_.find(aliasId);
+        if (alias == uploads_.end() || alias->second->coalescedInto != uploadId) {
+            continue;
+        }
+        FileUploadTaskInfo& aliasProgress = *alias->second;
+        aliasProgress.bytesSent = bytesSent;
+        aliasProgress.bytesPerSecond = bytesPerSecond;
+        aliasProgress.averageBytesPerSecond = averageBytesPerSecond;
+        aliasProgress.lastProgressTime = progress.lastProgressTime;
+        publishStatusBoardInternal(aliasProgress);
+    }
+}
+
+// Merge a pending REAL_TIME_APPEND upload into an earlier one for the same file and object
+String AsyncUploadManager::coalesceAppendUpload(const String& uploadId) {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    auto it = uploads_.find(uploadId);
+    if (it == uploads_.end() || it->second->fileOperationType != REAL_TIME_APPEND) {
+        return "";
+    }
+    FileUploadTaskInfo& progress = *it->second;
+    String key = appendCoalesceKey(progress);
+
+    auto pending = pendingAppendUploads_.find(key);
+    if (pending != pendingAppendUploads_.end() && pending->second != uploadId) {
+        auto target = uploads_.find(pending->second);
+        // Only merge into a task the worker has not started (queued or parked); it reads
+        // the file after leaving UPLOAD_PENDING, which happens under this lock
+        if (target != uploads_.end()) {
+            FileUploadTaskInfo& survivor = *target->second;
+            bool notStarted = survivor.status == UPLOAD_PENDING || survivor.status == UPLOAD_QUEUED_DEFERRED;
+            if (notStarted && !survivor.shouldCancel.load() &&
+                survivor.dataId == progress.dataId && survivor.patientId == progress.patientId &&
+                survivor.region == progress.region && survivor.bucketName == progress.bucketName) {
+                progress.coalescedInto = survivor.uploadId;
+                survivor.coalescedUploadIds.push_back(uploadId);
+                publishStatusBoardInternal(progress);
+                return survivor.uploadId;
+            }
+        }
+    }
+
+    // Later submissions for this file and object merge into this task
+    pendingAppendUploads_[key] = uploadId;
+    return "";
+}
+
+// Set the cancellation flag if the upload can still be cancelled
+bool AsyncUploadManager::requestCancelInternal(FileUploadTaskInfo& progress) {
+    if (progress.status == UPLOAD_QUEUED_DEFERRED) {
+        // Parked uploads are not with the worker yet; promotion drops them from deferredQueue_
+        std::vector<String> updatedIds;
+        applyStatusInternal(progress, UPLOAD_CANCELLED, "", updatedIds);
+        for (const String& updatedId : updatedIds) {
+            UploadJournal::getInstance().recordState(updatedId, UPLOAD_CANCELLED);
+            UploadNotifier::getInstance().notifyStatus(updatedId, progress.dataId, UPLOAD_CANCELLED, progress.totalSize);
+        }
+        return true;
+    }
+    if (progress.status != UPLOAD_PENDING && progress.status != UPLOAD_UPLOADING) {
+        return false;
+    }
+
+    if (!progress.coalescedInto.empty()) {
+        // Detach from the surviving task; its transfer continues for the other submissions
+        auto survivor = uploads_.find(progress.coalescedInto);
+        if (survivor != uploads_.end()) {
+            auto& aliases = survivor->second->coalescedUploadIds;
+            aliases.erase(std::remove(aliases.begin(), aliases.end(), progress.uploadId), aliases.end());
+        }
+        progress.coalescedInto.clear();
+        trackFinishedInternal(progress.dataId, progress.status, UPLOAD_CANCELLED);
+        progress.status = UPLOAD_CANCELLED;
+        progress.statusVersion = bumpStatusVersionInternal(progress.dataId);
+        publishStatusBoardInternal(progress);
+        UploadJournal::getInstance().recordState(progress.uploadId, UPLOAD_CANCELLED);
+        UploadNotifier::getInstance().notifyStatus(progress.uploadId, progress.dataId, UPLOAD_CANCELLED, progress.totalSize);
+        return true;
+    }
+
+    progress.shouldCancel = true;
+    return true;
+}
+
+// Summarize a dataId and copy the uploads in [uploadOffset, uploadOffset + uploadLimit)
+// Assumes upload_data_map_mutex_ is held
+void AsyncUploadManager::collectStatusInternal(const String& dataId, size_t uploadOffset, size_t uploadLimit,
+                                               DataIdStatusBatchEntry& entry, unsigned long long changedSince) const {
+    entry.dataId = dataId;
+
+    auto status = dataIdStatus_.find(dataId);
+    auto group = dataIdUploads_.find(dataId);
+    if (status == dataIdStatus_.end() || group == dataIdUploads_.end()) {
+        return;
+    }
+    entry.version = status->second.version;
+    entry.membershipVersion = status->second.membershipVersion();
+
+    auto now = std::chrono::steady_clock::now();
+    size_t index = 0;
+    for (UploadHandle handle : group->second) {
+        const UploadSlot* slot = uploadHandles_.get(handle);
+        if (!slot) {
+            continue;
+        }
+        unsigned long long uploadVersion;
+        if (slot->live) {
+            entry.summary.add(slot->live->status, slot->live->totalSize, slot->live->errorMessage,
+                              getUploadTransferInfo(*slot->live, now));
+            uploadVersion = slot->live->statusVersion;
+        } else {
+            entry.summary.add(slot->archived.status, slot->archived.totalSize, archive_.errorMessageOf(slot->archived));
+            uploadVersion = slot->archived.statusVersion;
+        }
+        // Only changed uploads inside the requested window are materialized
+        if (index >= uploadOffset && index - uploadOffset < uploadLimit && uploadVersion > changedSince) {
+            if (auto progress = resolveHandleInternal(handle)) {
+                entry.uploads.push_back(progress);
+            }
+        }
+        ++index;
+    }
+    entry.summary.finish();
+}
+
+// Collect the status of many dataIds under a single lock acquisition
+std::vector<DataIdStatusBatchEntry> AsyncUploadManager::getStatusBatch(const std::vector<String>& dataIds,
+                                                                      bool includeUploads) const {
+    std::vector<DataIdStatusBatchEntry> entries(dataIds.size());
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    for (size_t i = 0; i < dataIds.size(); ++i) {
+        collectStatusInternal(dataIds[i], 0, includeUploads ? SIZE_MAX : 0, entries[i]);
+    }
+    return entries;
+}
+
+// Collect the summary of a dataId and one page of its uploads
+DataIdStatusBatchEntry AsyncUploadManager::getStatusPage(const String& dataId, size_t uploadOffset, size_t uploadLimit) const {
+    DataIdStatusBatchEntry entry;
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    collectStatusInternal(dataId, uploadOffset, uploadLimit, entry);
+    return entry;
+}
+
+// Collect the summary of a dataId and the uploads that changed after sinceVersion
+DataIdStatusBatchEntry AsyncUploadManager::getStatusDelta(const String& dataId, unsigned long long sinceVersion,
+                                                          bool& full) const {
+    DataIdStatusBatchEntry entry;
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    full = true;
+    auto status = dataIdStatus_.find(dataId);
+    if (status != dataIdStatus_.end()) {
+        // Removed uploads cannot be expressed as changes - fall back to the full list
+        full = sinceVersion == 0 || sinceVersion < status->second.lastRemovalVersion ||
+               sinceVersion > status->second.version;
+    }
+    collectStatusInternal(dataId, 0, SIZE_MAX, entry, full ? 0 : sinceVersion);
+    return entry;
+}
+
+// Block until the status of a dataId changes or all of its uploads are finished
+int AsyncUploadManager::waitForStatusChange(const String& dataId, unsigned long long sinceVersion, long timeoutMs,
+                                            unsigned long long& version) {
+    std::unique_lock<std::mutex> lock(upload_data_map_mutex_);
+    int result = STATUS_WAIT_TIMEOUT;
+    auto evaluate = [&]() {
+        auto it = dataIdStatus_.find(dataId);
+        if (it == dataIdStatus_.end()) {
+            version = 0;
+            result = STATUS_WAIT_UNKNOWN;
+            return true;
+        }
+        version = it->second.version;
+        if (version != sinceVersion) {
+            result = STATUS_WAIT_CHANGED;
+            return true;
+        }
+        if (it->second.unfinishedUploads == 0) {
+            result = STATUS_WAIT_FINISHED;
+            return true;
+        }
+        return false;
+    };
+
+    if (evaluate() || timeoutMs <= 0) {
+        return result;
+    }
+
+    statusWaiters_++;
+    bool signalled = statusCondition_.wait_for(lock, std::chrono::milliseconds(timeoutMs), evaluate);
+    statusWaiters_--;
+    return signalled ? result : STATUS_WAIT_TIMEOUT;
+}
+
+// Return the budget held by an upload
+void AsyncUploadManager::releaseAdmission(const String& uploadId) {
+    long long bytes = -1;
+    {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = uploads_.find(uploadId);
+        if (it != uploads_.end()) {
+            bytes = it->second->admittedBytes;
+            it->second->admittedBytes = -1;
+        }
+    }
+    if (bytes >= 0) {
+        admission_.release(bytes);
+    }
+}
+
+// Move deferred uploads into the worker queue while budget allows
+// Lock order: queueMutex_ -> upload_data_map_mutex_ (via promoteDeferredInternal)
+size_t AsyncUploadManager::promoteDeferredUploads() {
+    size_t promotedCount = 0;
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        while (!deferredQueue_.empty()) {
+            const std::pair<String, long long>& next = deferredQueue_.front();
+            DeferredPromotion promotion = promoteDeferredInternal(next.first, next.second);
+            if (promotion == DEFERRED_WAITING) {
+                break;
+            }
+            // Uploads removed or cancelled while parked are dropped
+            if (promotion == DEFERRED_PROMOTED) {
+                uploadQueue_.push_back(next.first);
+                promotedCount++;
+            }
+            deferredQueue_.pop_front();
+        }
+    }
+
+    if (promotedCount > 0) {
+        AWS_LOGSTREAM_INFO("S3Upload", "Promoted " << promotedCount << " deferred upload(s) to the worker queue");
+        queueCondition_.notify_one();
+    }
+    return promotedCount;
+}
+
+// Admit a parked upload and move it back to UPLOAD_PENDING
+AsyncUploadManager::DeferredPromotion AsyncUploadManager::promoteDeferredInternal(const String& uploadId, long long bytes) {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+    auto it = uploads_.find(uploadId);
+    if (it == uploads_.end() || it->second->status != UPLOAD_QUEUED_DEFERRED) {
+        return DEFERRED_DROPPED;
+    }
+    if (!admission_.tryAdmit(bytes)) {
+        return DEFERRED_WAITING;
+    }
+
+    // Budget must be recorded before the worker can see the task
+    FileUploadTaskInfo& progress = *it->second;
+    progress.admittedBytes = bytes;
+    std::vector<String> updatedIds;
+    applyStatusInternal(progress, UPLOAD_PENDING, "", updatedIds);
+    for (const String& updatedId : updatedIds) {
+        UploadJournal::getInstance().recordState(updatedId, UPLOAD_PENDING);
+        UploadNotifier::getInstance().notifyStatus(updatedId, progress.dataId, UPLOAD_PENDING, progress.totalSize);
+    }
+    return DEFERRED_PROMOTED;
+}
+
+// Convert finished uploads to their compact archived form
+size_t AsyncUploadManager::compactFinishedUploads() {
+    std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+
+    size_t archivedCount = 0;
+    for (auto it = uploads_.begin(); it != uploads_.end();) {
+        const std::shared_ptr<FileUploadTaskInfo>& task = it->second;
+        bool finished = isFinalUploadStatus(task->status);
+
+        // References held by uploads_ and the slot map only - nobody else is using the task
+        // Tasks still holding budget wait until the worker returns it
+        if (!finished || task.use_count() > 2 || task->admittedBytes >= 0) {
+            ++it;
+            continue;
+        }
+
+        UploadSlot* slot = uploadHandles_.get(task->handle);
+        if (slot) {
+            slot->archived = archive_.archive(*task);
+            slot->live.reset();
+        }
+        it = uploads_.erase(it);
+        archivedCount++;
+    }
+
+    if (archivedCount > 0) {
+        AWS_LOGSTREAM_INFO("S3Upload", "Archived " << archivedCount << " finished upload(s), "
+                          << uploads_.size() << " live, " << archive_.internedStringCount() << " interned strings");
+    }
+    return archivedCount;
+}
+
 // Initialize AWS SDK
 const char* InitializeAwsSDK() {
     // If SDK is already initialized, return success status
@@ -193,8 +745,10 @@ extern "C" S3UPLOAD_API long __stdcall GetS3FileSize(const char* filePath) {
     return static_cast<long>(file.tellg());
 }
 
-// Set credentials
-extern "C" S3UPLOAD_API const char* __stdcall SetCredential(const char* hippoApiUrl, const char* userName, const char* password) {
+// Initialize the SDK and set up HippoClient credentials
+// Shared by SetCredential and the background initialization of SetCredentialAsync
+// Returns the response JSON; assumes g_setCredentialMutex is held
+static String ApplyCredential(const String& hippoApiUrl, const String& userName, const String& password) {
     // Call InitializeAwsSDK first
     const char* initResult = InitializeAwsSDK();
     
@@ -204,31 +758,164 @@ extern "C" S3UPLOAD_API const char* __stdcall SetCredential(const char* hippoApi
         String initResultStr = initResult;
         if (initResultStr.find("\"code\":5") == String::npos) {
             // SDK initialization failed, return the error
-            return initResult;
+            return initResultStr;
         }
         
         // SDK initialized successfully, now set up HippoClient credentials
+        // S3 credentials cached for another account must not be reused
+        if (g_apiUrl != hippoApiUrl || g_email != userName) {
+            S3ClientRegistry::instance().clear();
+        }
         g_apiUrl = hippoApiUrl;
         g_email = userName;
         g_password = password;
         
         // Initialize HippoClient with credentials
         HippoClient::Init(g_apiUrl, g_email, g_password);
+
+        // Pick up the account's cached JWT and S3 credentials (only if the cache is enabled)
+        bool cachedToken = CredentialCache::getInstance().selectAccount(g_apiUrl, g_email, g_password);
         
         // Log the credential setup
-        AWS_LOGSTREAM_INFO("S3Upload", "Credentials set - URL: " << g_apiUrl << ", Email: " << g_email);
+        AWS_LOGSTREAM_INFO("S3Upload", "Credentials set - URL: " << g_apiUrl << ", Email: " << g_email
+                          << ", cached JWT: " << (cachedToken ? "yes" : "no"));
+
+        // Resume uploads left unfinished by a previous process (only if the journal is enabled)
+        ReplayUploadJournal();
         
         // Return success response
-        static std::string response = create_response(SDK_INIT_SUCCESS, "AWS SDK initialized and credentials set successfully");
-        return response.c_str();
+        return create_response(SDK_INIT_SUCCESS, "AWS SDK initialized and credentials set successfully");
         
     } catch (const std::exception& e) {
-        static std::string response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to set credentials", e.what()));
-        return response.c_str();
+        return create_response(UPLOAD_FAILED, formatErrorMessage("Failed to set credentials", e.what()));
     } catch (...) {
-        static std::string response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to set credentials", ErrorMessage::UNKNOWN_ERROR));
+        return create_response(UPLOAD_FAILED, formatErrorMessage("Failed to set credentials", ErrorMessage::UNKNOWN_ERROR));
+    }
+}
+
+// Set credentials
+extern "C" S3UPLOAD_API const char* __stdcall SetCredential(const char* hippoApiUrl, const char* userName, const char* password) {
+    if (!hippoApiUrl || !userName || !password) {
+        static std::string response = create_response(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::INVALID_PARAMETERS));
+        return response.c_str();
+    }
+
+    static std::string response;
+    std::lock_guard<std::mutex> lock(g_setCredentialMutex);
+    response = ApplyCredential(hippoApiUrl, userName, password);
+    {
+        std::lock_guard<std::mutex> readinessLock(g_readinessMutex);
+        g_lastCredentialResult = response;
+    }
+    return response.c_str();
+}
+
+// Background initialization started by SetCredentialAsync
+// Step 1 runs under the same lock as SetCredential; uploads are released as soon as it is
+// done, and the warm-up (step 2) continues alongside them.
+static void credentialInitThread(String hippoApiUrl, String userName, String password) {
+    // Step 1: Initialize the SDK and set the credentials
+    String result;
+    {
+        std::lock_guard<std::mutex> lock(g_setCredentialMutex);
+        result = ApplyCredential(hippoApiUrl, userName, password);
+    }
+    bool succeeded = result.find("\"code\":5") != String::npos;
+
+    // Release uploads waiting on the readiness barrier
+    {
+        std::lock_guard<std::mutex> lock(g_readinessMutex);
+        g_lastCredentialResult = result;
+        g_pendingInitializations--;
+    }
+    g_readinessCondition.notify_all();
+    if (!succeeded) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Background initialization failed: " << result);
+        return;
+    }
+
+    // Step 2: Log in (or take the cached JWT) over a warmed-up API connection
+    auto start = std::chrono::steady_clock::now();
+    bool apiReady = HippoClient::Prewarm();
+
+    auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    AWS_LOGSTREAM_INFO("S3Upload", "Background warm-up finished in " << elapsedMs << " ms - API: "
+                      << (apiReady ? "ready" : "failed"));
+}
+
+// Set credentials without blocking the caller
+// SDK initialization and credential setup run on a background thread, followed by the
+// login over a warmed-up connection to the Hippo API. Use PrewarmUploadTarget to also
+// warm the S3 client of the first upload.
+// Uploads submitted in the meantime are accepted; the worker holds them until the
+// credentials are set. Use WaitForCredential to learn the outcome.
+// Returns code 0 (UPLOAD_PENDING) once initialization has started
+extern "C" S3UPLOAD_API const char* __stdcall SetCredentialAsync(const char* hippoApiUrl, const char* userName,
+                                                                 const char* password) {
+    if (!hippoApiUrl || !userName || !password) {
+        static std::string response = create_response(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::INVALID_PARAMETERS));
         return response.c_str();
     }
+
+    try {
+        {
+            std::lock_guard<std::mutex> lock(g_readinessMutex);
+            g_pendingInitializations++;
+        }
+        // Detached: completion is tracked by g_pendingInitializations, and the thread must not
+        // be joined from DllMain
+        std::thread(credentialInitThread, String(hippoApiUrl), String(userName), String(password)).detach();
+    } catch (const std::exception& e) {
+        {
+            std::lock_guard<std::mutex> lock(g_readinessMutex);
+            g_pendingInitializations--;
+        }
+        g_readinessCondition.notify_all();
+        static std::string response;
+        response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to start initialization", e.what()));
+        return response.c_str();
+    }
+
+    static std::string response = create_response(UPLOAD_PENDING, "AWS SDK initialization started in the background");
+    return response.c_str();
+}
+
+bool IsSdkInitializing() {
+    std::lock_guard<std::mutex> lock(g_readinessMutex);
+    return g_pendingInitializations > 0;
+}
+
+bool IsSdkReady() {
+    return g_isInitialized && !IsSdkInitializing();
+}
+
+bool WaitForSdkReady(long timeoutMs) {
+    std::unique_lock<std::mutex> lock(g_readinessMutex);
+    auto initialized = [] { return g_pendingInitializations == 0; };
+    if (timeoutMs < 0) {
+        g_readinessCondition.wait(lock, initialized);
+    } else if (!g_readinessCondition.wait_for(lock, std::chrono::milliseconds(timeoutMs), initialized)) {
+        return false;
+    }
+    return g_isInitialized;
+}
+
+// Wait for the background initialization started by SetCredentialAsync
+// timeoutMs: 0 polls, < 0 waits indefinitely
+// Returns code 0 (UPLOAD_PENDING) while it is still running, otherwise the response
+// SetCredential would have returned
+extern "C" S3UPLOAD_API const char* __stdcall WaitForCredential(int timeoutMs) {
+    static std::string response;
+    WaitForSdkReady(timeoutMs);
+    std::lock_guard<std::mutex> lock(g_readinessMutex);
+    if (g_pendingInitializations > 0) {
+        response = create_response(UPLOAD_PENDING, "AWS SDK initialization in progress");
+    } else if (g_lastCredentialResult.empty()) {
+        response = create_response(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::SDK_NOT_INITIALIZED));
+    } else {
+        response = g_lastCredentialResult;
+    }
+    return response.c_str();
 }
 
 // Backend API confirmation function
@@ -283,43 +970,53 @@ bool ConfirmUploadRawFile(const String& dataId,
     }
 }
 
+// Build the incremental confirmation payload (same shape as ConfirmUploadRawFile)
+static nlohmann::json BuildIncrementalConfirmationPayload(const String& dataId,
+                                                          const String& uploadDataName, const String& patientId,
+                                                          long long uploadFileSizeBytes, const String& s3ObjectKey) {
+    nlohmann::json payload;
+    payload["dataId"] = dataId;
+    payload["dataName"] = uploadDataName;
+    payload["fileName"] = s3ObjectKey;
+    payload["dataSize"] = uploadFileSizeBytes;
+    payload["patientId"] = patientId;
+    payload["dataType"] = 20;
+    payload["uploadDataName"] = uploadDataName;
+    payload["isRawDataInternal"] = 1;
+    payload["dataVersions"] = nlohmann::json::array({0});
+    return payload;
+}
+
+// Check the incremental confirmation response
+// Success criteria: { "status": { "code": "OK", "message": "OK" }}
+static bool IsIncrementalConfirmationOk(const nlohmann::json& response, const String& dataId, const String& s3ObjectKey) {
+    AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation response: " << response.dump(2));
+    if (response.contains("status") && response["status"].is_object()) {
+        auto status = response["status"];
+        if (status.contains("code") && status["code"].is_string() &&
+            status.contains("message") && status["message"].is_string()) {
+            String code = status["code"].get<String>();
+            String message = status["message"].get<String>();
+            if (code == "OK" && message == "OK") {
+                AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation OK for dataId: " << dataId << ", file: " << s3ObjectKey);
+                return true;
+            }
+        }
+    }
+
+    AWS_LOGSTREAM_WARN("S3Upload", "Incremental confirmation NOT OK for dataId: " << dataId << ", file: " << s3ObjectKey);
+    return false;
+}
+
 // Backend API incremental confirmation function
 bool ConfirmIncrementalUploadFile(const String& dataId,
                                   const String& uploadDataName, const String& patientId,
                                   long long uploadFileSizeBytes, const String& s3ObjectKey) {
     try {
-        // Build JSON payload (same shape as ConfirmUploadRawFile)
-        nlohmann::json payload;
-        payload["dataId"] = dataId;
-        payload["dataName"] = uploadDataName;
-        payload["fileName"] = s3ObjectKey;
-        payload["dataSize"] = uploadFileSizeBytes;
-        payload["patientId"] = patientId;
-        payload["dataType"] = 20;
-        payload["uploadDataName"] = uploadDataName;
-        payload["isRawDataInternal"] = 1;
-        payload["dataVersions"] = nlohmann::json::array({0});
-
         // Call incremental confirm API
-        nlohmann::json response = HippoClient::ConfirmIncrementalUploadFile(payload);
-        AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation response: " << response.dump(2));
-
-        // Success criteria: { "status": { "code": "OK", "message": "OK" }}
-        if (response.contains("status") && response["status"].is_object()) {
-            auto status = response["status"];
-            if (status.contains("code") && status["code"].is_string() &&
-                status.contains("message") && status["message"].is_string()) {
-                String code = status["code"].get<String>();
-                String message = status["message"].get<String>();
-                if (code == "OK" && message == "OK") {
-                    AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation OK for dataId: " << dataId << ", file: " << s3ObjectKey);
-                    return true;
-                }
-            }
-        }
-
-        AWS_LOGSTREAM_WARN("S3Upload", "Incremental confirmation NOT OK for dataId: " << dataId << ", file: " << s3ObjectKey);
-        return false;
+        nlohmann::json response = HippoClient::ConfirmIncrementalUploadFile(
+            BuildIncrementalConfirmationPayload(dataId, uploadDataName, patientId, uploadFileSizeBytes, s3ObjectKey));
+        return IsIncrementalConfirmationOk(response, dataId, s3ObjectKey);
     } catch (const std::exception& e) {
         AWS_LOGSTREAM_ERROR("S3Upload", "Exception in ConfirmIncrementalUploadFile: " << e.what());
         return false;
@@ -329,6 +1026,28 @@ bool ConfirmIncrementalUploadFile(const String& dataId,
     }
 }
 
+// Start an incremental confirmation on the multiplexed request path
+HippoClient::AsyncResponse BeginIncrementalUploadConfirmation(const String& dataId,
+                                                              const String& uploadDataName, const String& patientId,
+                                                              long long uploadFileSizeBytes, const String& s3ObjectKey) {
+    return HippoClient::ConfirmIncrementalUploadFileAsync(
+        BuildIncrementalConfirmationPayload(dataId, uploadDataName, patientId, uploadFileSizeBytes, s3ObjectKey));
+}
+
+// Wait for an incremental confirmation and check its response
+bool FinishIncrementalUploadConfirmation(HippoClient::AsyncResponse& response,
+                                         const String& dataId, const String& s3ObjectKey) {
+    try {
+        return IsIncrementalConfirmationOk(response.Get(), dataId, s3ObjectKey);
+    } catch (const std::exception& e) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Exception in FinishIncrementalUploadConfirmation: " << e.what());
+        return false;
+    } catch (...) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Unknown exception in FinishIncrementalUploadConfirmation");
+        return false;
+    }
+}
+
 // S3 client creation helper
 Aws::S3::S3Client createS3Client(const String& accessKey, 
                                 const String& secretKey, 
@@ -18,9 +18,14 @@
 #include <unordered_map>
 #include <vector>
 #include <queue>
+#include <deque>
 #include <condition_variable>
+// For std::min
+#include <algorithm>
 // For strlen
 #include <cstring>
+// For SIZE_MAX
+#include <cstdint>
 // For std::quoted
 #include <iomanip>
 // For Windows API types
@@ -63,6 +68,28 @@ inline unsigned __int64 _byteswap_uint64(unsigned __int64 x) {
 // HippoClient for backend API calls
 #include "request/hippo_client.h"
 
+// Handle-addressed storage and compact archive for upload records
+#include "upload_slot_map.h"
+#include "upload_archive.h"
+
+// Byte/task budget for queued uploads
+#include "upload_admission.h"
+
+// Write-ahead log of upload submissions and state transitions
+#include "upload_journal.h"
+
+// Callback / window message / event delivery of upload notifications
+#include "upload_notifier.h"
+
+// Throughput sampling of running transfers
+#include "transfer_rate.h"
+
+// Shared-memory status table for out-of-process monitors
+#include "upload_status_board.h"
+
+// Encrypted warm-start cache of the JWT and S3 credentials
+#include "credential_cache.h"
+
 // DLL export macro definition
 #ifdef S3UPLOAD_EXPORTS
 #define S3UPLOAD_API __declspec(dllexport)
@@ -74,12 +101,14 @@ inline unsigned __int64 _byteswap_uint64(unsigned __int64 x) {
 // Maximum number of retry attempts for failed uploads
 static const int MAX_UPLOAD_RETRIES = 3;
 
-// Maximum number of concurrent uploads allowed
-static const size_t MAX_UPLOAD_LIMIT = 100;
-
 // Upload ID separator constant (used in uploadId = dataId + "_" + timestamp)
 static const String UPLOAD_ID_SEPARATOR = "_";
 
+// Compact 64-bit upload handle (generation << 32 | slot index), 0 = invalid
+// Exposed to hosts as a signed 64-bit integer (C# long, VB6 Currency)
+typedef unsigned long long UploadHandle;
+static const UploadHandle INVALID_UPLOAD_HANDLE = 0;
+
 // Upload ID helper functions
 inline String getUploadIdPrefixByDataId(const String& dataId) {
     return dataId + UPLOAD_ID_SEPARATOR;
@@ -128,14 +157,30 @@ enum UploadStatus {
     // Upload confirmation with backend API completed successfully
     CONFIRM_SUCCESS = 7,
     // Upload successful but confirmation failed
-    CONFIRM_FAILED = 8
+    CONFIRM_FAILED = 8,
+    // Upload accepted but parked until the upload budget frees up (ADMISSION_DEFER)
+    UPLOAD_QUEUED_DEFERRED = 9
 };
 
+// Check whether an upload status is final (the upload will not change state again)
+// UPLOAD_SUCCESS is not final - backend confirmation is still pending
+inline bool isFinalUploadStatus(int status) {
+    return status == CONFIRM_SUCCESS || status == CONFIRM_FAILED ||
+           status == UPLOAD_FAILED || status == UPLOAD_CANCELLED;
+}
+
+// Check whether all bytes of an upload reached S3 (confirmation may still be pending or have failed)
+inline bool isTransferredUploadStatus(int status) {
+    return status == UPLOAD_SUCCESS || status == CONFIRM_SUCCESS || status == CONFIRM_FAILED;
+}
+
 // Async upload progress information structure
 // Contains all tracking data for a single upload operation
 struct FileUploadTaskInfo {
     // Unique identifier for this upload
     String uploadId;
+    // Slot map handle for this upload (alternative to uploadId for FFI callers)
+    UploadHandle handle;
     // Current status of the upload
     UploadStatus status;
     // Total size of file being uploaded (in bytes)
@@ -166,8 +211,227 @@ struct FileUploadTaskInfo {
     String region;
     String bucketName;
 
+    // Bytes reserved in the admission budget (-1 = not holding budget)
+    long long admittedBytes;
+
+    // Status version of the last change to this upload (see DataIdStatusCache)
+    unsigned long long statusVersion;
+
+    // REAL_TIME_APPEND coalescing (see AsyncUploadManager::coalesceAppendUpload)
+    // uploadId of the queued task this one was merged into (empty = uploads itself)
+    String coalescedInto;
+    // uploadIds merged into this task; they mirror its status
+    std::vector<String> coalescedUploadIds;
+
+    // Transfer progress of the current attempt (see AsyncUploadManager::updateTransferProgress)
+    long long bytesSent;
+    // Throughput over the last sample window and its moving average (bytes per second)
+    long long bytesPerSecond;
+    long long averageBytesPerSecond;
+    // When bytesSent last advanced
+    std::chrono::steady_clock::time_point lastProgressTime;
+
     // Constructor - initialize with default values
-    FileUploadTaskInfo() : status(UPLOAD_PENDING), totalSize(0), shouldCancel(false), confirmationAttempted(false), fileOperationType(BATCH_CREATE) {}
+    FileUploadTaskInfo() : handle(INVALID_UPLOAD_HANDLE), status(UPLOAD_PENDING), totalSize(0), shouldCancel(false), confirmationAttempted(false), fileOperationType(BATCH_CREATE), admittedBytes(-1), statusVersion(0), bytesSent(0), bytesPerSecond(0), averageBytesPerSecond(0) {}
+};
+
+// Transfer figures of an upload as reported by the status exports
+struct UploadTransferInfo {
+    // Bytes that reached S3 (totalSize once transferred)
+    long long bytesSent;
+    // Current and moving-average throughput (0 unless uploading and not stalled)
+    long long bytesPerSecond;
+    long long averageBytesPerSecond;
+    // Estimated seconds until the transfer completes (-1 = unknown)
+    long long etaSeconds;
+
+    UploadTransferInfo() : bytesSent(0), bytesPerSecond(0), averageBytesPerSecond(0), etaSeconds(-1) {}
+};
+
+// Derive the reported transfer figures of an upload at time now
+// A transfer that has not advanced for TRANSFER_STALL_MS reports a current rate of 0
+inline UploadTransferInfo getUploadTransferInfo(const FileUploadTaskInfo& progress, std::chrono::steady_clock::time_point now) {
+    UploadTransferInfo info;
+    if (isTransferredUploadStatus(progress.status)) {
+        info.bytesSent = progress.totalSize;
+        info.etaSeconds = 0;
+        return info;
+    }
+    info.bytesSent = progress.bytesSent;
+    if (progress.status != UPLOAD_UPLOADING) {
+        return info;
+    }
+
+    long long idleMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - progress.lastProgressTime).count();
+    info.bytesPerSecond = idleMs < TRANSFER_STALL_MS ? progress.bytesPerSecond : 0;
+    info.averageBytesPerSecond = progress.averageBytesPerSecond;
+    if (info.averageBytesPerSecond > 0) {
+        long long remaining = progress.totalSize > info.bytesSent ? progress.totalSize - info.bytesSent : 0;
+        info.etaSeconds = (remaining + info.averageBytesPerSecond - 1) / info.averageBytesPerSecond;
+    }
+    return info;
+}
+
+// Status version and cached status JSON of one dataId
+// The version is bumped on every change that is visible in the status JSON
+struct DataIdStatusCache {
+    // Current version (taken from a manager-wide counter, so it never repeats for a dataId)
+    unsigned long long version;
+    // Version the snapshot was built at
+    unsigned long long snapshotVersion;
+    // Transfer samples published for the dataId (advanced once per TransferRateMeter window)
+    // Samples change bytesSent, rate and ETA in the JSON but not the status version
+    unsigned long long sampleCount;
+    // Sample count the snapshot was built at
+    unsigned long long snapshotSampleCount;
+    // A snapshot built while a transfer runs expires here, so a stall (no more samples)
+    // shows up one sample window late at most; time_point() = never expires
+    std::chrono::steady_clock::time_point snapshotExpiry;
+    // Version at which an upload of the dataId was last removed (0 = never)
+    // Delta queries from before this version must return the full upload list
+    unsigned long long lastRemovalVersion;
+    // Version at which an upload was last added to the dataId
+    // Together with lastRemovalVersion it tells whether the upload list itself changed
+    unsigned long long lastAdditionVersion;
+    // Number of uploads of the dataId that have not reached a final status
+    size_t unfinishedUploads;
+    // Serialized status of the dataId (GetAsyncUploadStatusBytes format), nullptr if none yet
+    std::shared_ptr<const String> snapshot;
+
+    DataIdStatusCache() : version(0), snapshotVersion(0), sampleCount(0), snapshotSampleCount(0),
+                          lastRemovalVersion(0), lastAdditionVersion(0), unfinishedUploads(0) {}
+
+    // Version of the last addition or removal (paging stays valid while it is unchanged)
+    unsigned long long membershipVersion() const {
+        return (std::max)(lastRemovalVersion, lastAdditionVersion);
+    }
+};
+
+// Aggregated status of all uploads of a dataId (summary fields of GetAsyncUploadStatusBytes)
+// Feed every upload to add() in submission order, then call finish()
+struct UploadGroupSummary {
+    // Overall UploadStatus of the group (valid after finish())
+    int overallStatus;
+    // Uploads in UPLOAD_SUCCESS and their bytes
+    int uploadedCount;
+    long long uploadedSize;
+    // Bytes and number of all uploads
+    long long totalSize;
+    int totalUploadCount;
+    // Error message of the first failed upload
+    String errorMessage;
+    // Bytes that reached S3, including the running transfer
+    long long bytesSent;
+    // Current throughput of the running transfers (bytes per second)
+    long long bytesPerSecond;
+    // Estimated seconds until every pending and running upload is transferred (-1 = unknown)
+    long long etaSeconds;
+
+    UploadGroupSummary()
+        : overallStatus(UPLOAD_UPLOADING), uploadedCount(0), uploadedSize(0), totalSize(0), totalUploadCount(0),
+          bytesSent(0), bytesPerSecond(0), etaSeconds(-1), anyFailed_(false), anyUploading_(false), allConfirmed_(true),
+          anyConfirmFailed_(false), remainingBytes_(0), averageBytesPerSecond_(0) {}
+
+    // Add a finished (or not yet started) upload
+    void add(int status, long long size, const String& error) {
+        UploadTransferInfo transfer;
+        transfer.bytesSent = isTransferredUploadStatus(status) ? size : 0;
+        add(status, size, error, transfer);
+    }
+
+    void add(int status, long long size, const String& error, const UploadTransferInfo& transfer) {
+        bytesSent += transfer.bytesSent;
+        bytesPerSecond += transfer.bytesPerSecond;
+        averageBytesPerSecond_ += transfer.averageBytesPerSecond;
+        if (status == UPLOAD_PENDING || status == UPLOAD_UPLOADING || status == UPLOAD_QUEUED_DEFERRED) {
+            remainingBytes_ += size > transfer.bytesSent ? size - transfer.bytesSent : 0;
+        }
+
+        totalUploadCount++;
+        totalSize += size;
+        if (status == UPLOAD_SUCCESS) {
+            uploadedCount++;
+            uploadedSize += size;
+        } else if (status == UPLOAD_FAILED) {
+            if (!anyFailed_) {
+                errorMessage = error;
+            }
+            anyFailed_ = true;
+        } else if (status == UPLOAD_UPLOADING || status == UPLOAD_PENDING || status == UPLOAD_QUEUED_DEFERRED ||
+                   status == UPLOAD_CANCELLED) {
+            anyUploading_ = true;
+        }
+        if (status == CONFIRM_FAILED) {
+            anyConfirmFailed_ = true;
+        }
+        if (status != CONFIRM_SUCCESS) {
+            allConfirmed_ = false;
+        }
+    }
+
+    void finish() {
+        if (anyFailed_) {
+            overallStatus = UPLOAD_FAILED;
+        } else if (anyUploading_) {
+            overallStatus = UPLOAD_UPLOADING;
+        } else if (allConfirmed_) {
+            overallStatus = CONFIRM_SUCCESS;
+        } else if (anyConfirmFailed_) {
+            overallStatus = CONFIRM_FAILED;
+        } else {
+            // Upload completed, confirmation may be in progress
+            overallStatus = UPLOAD_SUCCESS;
+        }
+
+        // Uploads run one after another, so the running transfer's rate drains the rest
+        if (remainingBytes_ == 0) {
+            etaSeconds = 0;
+        } else if (averageBytesPerSecond_ > 0) {
+            etaSeconds = (remainingBytes_ + averageBytesPerSecond_ - 1) / averageBytesPerSecond_;
+        }
+    }
+
+private:
+    bool anyFailed_;
+    bool anyUploading_;
+    bool allConfirmed_;
+    bool anyConfirmFailed_;
+    long long remainingBytes_;
+    long long averageBytesPerSecond_;
+};
+
+// Status of one dataId collected by AsyncUploadManager::getStatusBatch
+struct DataIdStatusBatchEntry {
+    String dataId;
+    // Status version (0 = no uploads tracked for the dataId)
+    unsigned long long version;
+    // Version of the last upload addition or removal (see DataIdStatusCache::membershipVersion)
+    unsigned long long membershipVersion;
+    UploadGroupSummary summary;
+    // Uploads in submission order (only the requested ones)
+    std::vector<std::shared_ptr<FileUploadTaskInfo>> uploads;
+
+    DataIdStatusBatchEntry() : version(0), membershipVersion(0) {}
+};
+
+// Results of AsyncUploadManager::waitForStatusChange / WaitForUploadStatusChange
+// Timed out without a change
+static const int STATUS_WAIT_TIMEOUT = 0;
+// Status version changed
+static const int STATUS_WAIT_CHANGED = 1;
+// No change, but every upload of the dataId has reached a final status
+static const int STATUS_WAIT_FINISHED = 2;
+// No uploads are tracked for the dataId
+static const int STATUS_WAIT_UNKNOWN = -1;
+
+// Slot map entry for one upload
+// Holds the live task while it is in progress, and only its compact archived
+// record once it has finished (see AsyncUploadManager::compactFinishedUploads)
+struct UploadSlot {
+    // Live task, nullptr once archived
+    std::shared_ptr<FileUploadTaskInfo> live;
+    // Compact record, valid when live is nullptr
+    ArchivedUploadRecord archived;
 };
 
 // Async upload manager class - thread-safe singleton for managing multiple uploads
@@ -175,13 +439,25 @@ struct FileUploadTaskInfo {
 class AsyncUploadManager {
 private:
     mutable std::mutex upload_data_map_mutex_;  // Mutex for thread-safe operations
-    std::unordered_map<String, std::shared_ptr<FileUploadTaskInfo>> uploads_;  // Map of upload ID to progress info
+    std::unordered_map<String, std::shared_ptr<FileUploadTaskInfo>> uploads_;  // Map of upload ID to progress info (live uploads only)
+    GenerationalSlotMap<UploadSlot> uploadHandles_;  // Handle-indexed store of live and archived uploads (same lock)
+    std::unordered_map<String, std::vector<UploadHandle>> dataIdUploads_;  // dataId -> upload handles in submission order (same lock)
+    UploadArchive archive_;  // Compact storage for finished uploads (same lock)
+    std::unordered_map<String, String> pendingAppendUploads_;  // localFilePath + objectKey -> pending REAL_TIME_APPEND uploadId (same lock)
+    std::unordered_map<String, DataIdStatusCache> dataIdStatus_;  // dataId -> status version and cached snapshot (same lock)
+    unsigned long long statusVersion_ = 0;  // Last version handed out to dataIdStatus_ (same lock)
+    std::condition_variable statusCondition_;  // Signalled on every status version bump (waits on upload_data_map_mutex_)
+    size_t statusWaiters_ = 0;  // Threads blocked in waitForStatusChange (same lock)
     
     // Upload queue management
-    std::queue<String> uploadQueue_;  // FIFO queue for pending upload tasks (stores only uploadId)
-    mutable std::mutex queueMutex_;  // Protects access to uploadQueue_
+    std::deque<String> uploadQueue_;  // FIFO queue for pending upload tasks (stores only uploadId)
+    std::deque<std::pair<String, long long>> deferredQueue_;  // Accepted but not yet admitted uploads (uploadId, bytes)
+    mutable std::mutex queueMutex_;  // Protects access to uploadQueue_ and deferredQueue_
     std::condition_variable queueCondition_;  // Notifies worker thread when tasks are available
 
+    // Admission control
+    UploadAdmissionController admission_;  // Byte/task budget of queued and transferring uploads
+
 public:
     // Constructor
     AsyncUploadManager() = default;
@@ -200,6 +476,7 @@ public:
     String addUpload(const String& uploadId, const String& localFilePath, const String& s3ObjectKey, const String& patientId, const String& region, const String& bucketName);
 
     // Get upload progress information by ID
+    // Only live (unfinished or recently finished) uploads are returned
     // Returns shared_ptr to progress info or nullptr if not found
     std::shared_ptr<FileUploadTaskInfo> getUpload(const String& uploadId) {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
@@ -207,28 +484,43 @@ public:
         return it != uploads_.end() ? it->second : nullptr;
     }
 
+    // Get upload progress information by handle
+    // Array index + generation check, no hashing
+    // Archived uploads are returned as a read-only copy
+    // Returns shared_ptr to progress info or nullptr if handle is stale or unknown
+    std::shared_ptr<FileUploadTaskInfo> getUploadByHandle(UploadHandle handle) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        return resolveHandleInternal(handle);
+    }
+
+    // Get the status of an upload by handle without materializing archived records
+    // Returns false if the handle is stale or unknown
+    bool getUploadStatusByHandle(UploadHandle handle, UploadStatus& status) const;
+
     // Get upload progress information by dataId
     // Returns shared_ptr to progress info or nullptr if not found
     std::shared_ptr<FileUploadTaskInfo> getUploadByDataId(const String& dataId) {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
-        String prefix = getUploadIdPrefixByDataId(dataId);
-        for (auto& pair : uploads_) {
-            if (pair.first.find(prefix) == 0) {
-                return pair.second;
-            }
+        auto group = dataIdUploads_.find(dataId);
+        if (group == dataIdUploads_.end() || group->second.empty()) {
+            return nullptr;
         }
-        return nullptr;
+        return resolveHandleInternal(group->second.front());
     }
 
-    // Get all uploads that start with the given dataId
+    // Get all uploads with the given dataId, in submission order
+    // Archived uploads are included as read-only copies
     // Returns a vector of all matching upload progress info
     std::vector<std::shared_ptr<FileUploadTaskInfo>> getAllUploadsByDataId(const String& dataId) {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
         std::vector<std::shared_ptr<FileUploadTaskInfo>> result;
-        String prefix = getUploadIdPrefixByDataId(dataId);
-        for (auto& pair : uploads_) {
-            if (pair.first.find(prefix) == 0) {
-                result.push_back(pair.second);
+        auto group = dataIdUploads_.find(dataId);
+        if (group != dataIdUploads_.end()) {
+            result.reserve(group->second.size());
+            for (UploadHandle handle : group->second) {
+                if (auto progress = resolveHandleInternal(handle)) {
+                    result.push_back(progress);
+                }
             }
         }
         return result;
@@ -237,28 +529,292 @@ public:
     // Remove upload from tracking system (cleanup)
     void removeUpload(const String& uploadId) {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
-        uploads_.erase(uploadId);
+        auto it = uploads_.find(uploadId);
+        if (it != uploads_.end()) {
+            eraseUploadInternal(it->second->handle);
+        }
+    }
+
+    // Request cancellation of an upload
+    // The worker thread observes the flag between steps and marks the upload UPLOAD_CANCELLED
+    // Returns true if the upload exists and has not reached a final state yet
+    bool cancelUpload(const String& uploadId) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = uploads_.find(uploadId);
+        return it != uploads_.end() && requestCancelInternal(*it->second);
+    }
+
+    // Request cancellation of an upload by handle (see cancelUpload)
+    bool cancelUploadByHandle(UploadHandle handle) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto slot = uploadHandles_.get(handle);
+        return slot && slot->live && requestCancelInternal(*slot->live);
     }
 
     // Update upload status and error message
     // Thread-safe status updates for progress tracking
+    // Uploads coalesced into this one receive the same status, error and size
     void updateProgress(const String& uploadId, UploadStatus status,
-                       const String& error = "") {
+                       const String& error = "");
+
+    // Record the size of the file being uploaded
+    void setUploadTotalSize(const String& uploadId, long long totalSize) {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
         auto it = uploads_.find(uploadId);
         if (it != uploads_.end()) {
-            it->second->status = status;
-            if (!error.empty()) {
-                it->second->errorMessage = error;
+            it->second->totalSize = totalSize;
+            it->second->statusVersion = bumpStatusVersionInternal(it->second->dataId);
+            publishStatusBoardInternal(*it->second);
+        }
+    }
+
+    // Publish every tracked upload to the status board (after it was opened)
+    void publishAllToStatusBoard() const;
+
+    // Publish a throughput sample of a running transfer (and mirror it onto merged uploads)
+    // Does not bump the status version; transfer figures are read live
+    void updateTransferProgress(const String& uploadId, long long bytesSent,
+                                long long bytesPerSecond, long long averageBytesPerSecond);
+
+    // Get the status version of a dataId (0 if no uploads are tracked for it)
+    unsigned long long getStatusVersion(const String& dataId) const {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = dataIdStatus_.find(dataId);
+        return it != dataIdStatus_.end() ? it->second.version : 0;
+    }
+
+    // Get the cached status snapshot of a dataId
+    // version and sampleCount receive the current status version (0 = no uploads for the
+    // dataId) and transfer sample count
+    // Returns nullptr if no snapshot was built at both of them or it has expired
+    std::shared_ptr<const String> getStatusSnapshot(const String& dataId, unsigned long long& version,
+                                                    unsigned long long& sampleCount) const {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = dataIdStatus_.find(dataId);
+        if (it == dataIdStatus_.end()) {
+            version = 0;
+            sampleCount = 0;
+            return nullptr;
+        }
+        const DataIdStatusCache& cache = it->second;
+        version = cache.version;
+        sampleCount = cache.sampleCount;
+        if (cache.snapshotVersion != version || cache.snapshotSampleCount != sampleCount) {
+            return nullptr;
+        }
+        if (cache.snapshotExpiry.time_since_epoch().count() > 0 && std::chrono::steady_clock::now() >= cache.snapshotExpiry) {
+            return nullptr;
+        }
+        return cache.snapshot;
+    }
+
+    // Cache a snapshot built from the state at version and sampleCount
+    // Callers read both before the uploads, so a change in between leaves the stored
+    // snapshot behind and it is rebuilt on the next query
+    // A snapshot of a running transfer expires after one sample window (stall detection)
+    void storeStatusSnapshot(const String& dataId, unsigned long long version, unsigned long long sampleCount,
+                             bool transferring, std::shared_ptr<const String> snapshot) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = dataIdStatus_.find(dataId);
+        if (it != dataIdStatus_.end() && it->second.version == version && it->second.sampleCount == sampleCount) {
+            it->second.snapshotVersion = version;
+            it->second.snapshotSampleCount = sampleCount;
+            it->second.snapshotExpiry = transferring
+                ? std::chrono::steady_clock::now() + std::chrono::milliseconds(TRANSFER_RATE_SAMPLE_MS)
+                : std::chrono::steady_clock::time_point();
+            it->second.snapshot = std::move(snapshot);
+        }
+    }
+
+    // Collect the status of many dataIds under a single lock acquisition
+    // Summaries are computed directly from live and archived records; per-upload
+    // copies are only materialized when includeUploads is set
+    std::vector<DataIdStatusBatchEntry> getStatusBatch(const std::vector<String>& dataIds, bool includeUploads) const;
+
+    // Collect the summary of a dataId (over all uploads) and the uploads in
+    // [uploadOffset, uploadOffset + uploadLimit) in submission order
+    DataIdStatusBatchEntry getStatusPage(const String& dataId, size_t uploadOffset, size_t uploadLimit) const;
+
+    // Collect the summary of a dataId (over all uploads) and the uploads that changed after
+    // sinceVersion; versions and archived records are checked before anything is copied
+    // full is set (and every upload copied) if sinceVersion is 0, from before the last
+    // removal, or newer than the current version
+    DataIdStatusBatchEntry getStatusDelta(const String& dataId, unsigned long long sinceVersion, bool& full) const;
+
+    // Block until the status version of dataId differs from sinceVersion, every upload of
+    // the dataId has reached a final status, or timeoutMs elapses
+    // version receives the current status version (0 = no uploads for the dataId)
+    // Returns STATUS_WAIT_CHANGED, STATUS_WAIT_FINISHED, STATUS_WAIT_TIMEOUT or STATUS_WAIT_UNKNOWN
+    int waitForStatusChange(const String& dataId, unsigned long long sinceVersion, long timeoutMs,
+                            unsigned long long& version);
+
+    // Get all uploads of a dataId together with its status versions (see getAllUploadsByDataId)
+    // version receives the dataId's current status version (0 = no uploads)
+    // lastRemovalVersion receives the version of the last upload removal (0 = never)
+    std::vector<std::shared_ptr<FileUploadTaskInfo>> getAllUploadsByDataId(const String& dataId,
+                                                                           unsigned long long& version,
+                                                                           unsigned long long& lastRemovalVersion) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        std::vector<std::shared_ptr<FileUploadTaskInfo>> result;
+        version = 0;
+        lastRemovalVersion = 0;
+        auto status = dataIdStatus_.find(dataId);
+        if (status != dataIdStatus_.end()) {
+            version = status->second.version;
+            lastRemovalVersion = status->second.lastRemovalVersion;
+        }
+        auto group = dataIdUploads_.find(dataId);
+        if (group != dataIdUploads_.end()) {
+            result.reserve(group->second.size());
+            for (UploadHandle handle : group->second) {
+                if (auto progress = resolveHandleInternal(handle)) {
+                    result.push_back(progress);
+                }
             }
         }
+        return result;
+    }
+
+    // Merge a pending REAL_TIME_APPEND upload into an earlier one for the same file and object
+    // The worker reads the file when it starts the earlier task, so that single transfer
+    // carries the latest file state and is confirmed once; the merged upload mirrors its status.
+    // Must be called after fileOperationType is set and before the upload is enqueued.
+    // Returns the uploadId the upload was merged into, or empty if it must be queued itself
+    String coalesceAppendUpload(const String& uploadId);
+
+    // Check whether any upload (live or archived) is tracked for a dataId
+    bool hasUploadsForDataId(const String& dataId) const {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        return dataIdUploads_.find(dataId) != dataIdUploads_.end();
     }
 
+    // Get the admission controller (watermarks, policy, current budget)
+    UploadAdmissionController& getAdmission() {
+        return admission_;
+    }
+
+    // Record the budget an upload holds so it can be returned when the transfer ends
+    // Returns false if the upload no longer exists; the budget is then returned right away
+    bool setAdmittedBytes(const String& uploadId, long long bytes) {
+        std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
+        auto it = uploads_.find(uploadId);
+        if (it == uploads_.end()) {
+            admission_.release(bytes);
+            return false;
+        }
+        it->second->admittedBytes = bytes;
+        return true;
+    }
+
+    // Return the budget held by an upload (no-op if it holds none)
+    // Called once the worker is done with the task. An upload erased in the meantime
+    // already returned its budget in eraseUploadInternal, so a missing entry is a no-op.
+    void releaseAdmission(const String& uploadId);
+
+    // Park an accepted upload until budget frees up (ADMISSION_DEFER)
+    // The upload reports UPLOAD_QUEUED_DEFERRED until it is promoted
+    void deferUpload(const String& uploadId, long long bytes) {
+        updateProgress(uploadId, UPLOAD_QUEUED_DEFERRED);
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        deferredQueue_.push_back(std::make_pair(uploadId, bytes));
+    }
+
+    // Check whether uploads are waiting for budget
+    bool hasDeferredUploads() const {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        return !deferredQueue_.empty();
+    }
+
+    // Move deferred uploads into the worker queue, oldest first, while budget allows
+    // Promoted uploads go back to UPLOAD_PENDING; cancelled or removed ones are dropped
+    // Returns the number of uploads promoted
+    size_t promoteDeferredUploads();
+
+    // Convert finished uploads to their compact archived form
+    // A finished upload is archived only once nothing outside the manager references it,
+    // so the worker thread never loses a task it is still updating.
+    // Returns the number of uploads archived
+    size_t compactFinishedUploads();
+
+private:
+    // Set the cancellation flag if the upload can still be cancelled
+    // Coalesced and parked uploads are not with the worker, so they are cancelled directly
+    // Assumes upload_data_map_mutex_ is held
+    bool requestCancelInternal(FileUploadTaskInfo& progress);
+
+    // Apply a status change to an upload and the uploads coalesced into it
+    // updatedIds receives every uploadId whose status changed (for the journal and notifier)
+    // Assumes upload_data_map_mutex_ is held
+    void applyStatusInternal(FileUploadTaskInfo& progress, UploadStatus status, const String& error,
+                             std::vector<String>& updatedIds);
+
+    // Outcome of promoting the oldest parked upload
+    enum DeferredPromotion {
+        DEFERRED_PROMOTED,  // Admitted and back to UPLOAD_PENDING
+        DEFERRED_WAITING,   // Budget does not allow it yet
+        DEFERRED_DROPPED    // Removed or cancelled while parked
+    };
+
+    // Admit a parked upload if budget allows and move it back to UPLOAD_PENDING
+    // Lock order: queueMutex_ (held by the caller) -> upload_data_map_mutex_
+    DeferredPromotion promoteDeferredInternal(const String& uploadId, long long bytes);
+
+    // Mark the status of a dataId as changed (drops its cached snapshot)
+    // Returns the new version; assumes upload_data_map_mutex_ is held
+    unsigned long long bumpStatusVersionInternal(const String& dataId) {
+        DataIdStatusCache& cache = dataIdStatus_[dataId];
+        cache.version = ++statusVersion_;
+        cache.snapshot.reset();
+        if (statusWaiters_ > 0) {
+            statusCondition_.notify_all();
+        }
+        return cache.version;
+    }
+
+    // Publish the current state of an upload to the status board (no-op while it is closed)
+    // Assumes upload_data_map_mutex_ is held
+    void publishStatusBoardInternal(const FileUploadTaskInfo& progress) const;
+
+    // Keep DataIdStatusCache::unfinishedUploads in step with a status change
+    // Assumes upload_data_map_mutex_ is held
+    void trackFinishedInternal(const String& dataId, UploadStatus from, UploadStatus to) {
+        bool wasFinal = isFinalUploadStatus(from);
+        bool isFinal = isFinalUploadStatus(to);
+        if (wasFinal == isFinal) {
+            return;
+        }
+        size_t& unfinished = dataIdStatus_[dataId].unfinishedUploads;
+        if (isFinal) {
+            if (unfinished > 0) unfinished--;
+        } else {
+            unfinished++;
+        }
+    }
+
+    // Key of pendingAppendUploads_ for a task
+    static String appendCoalesceKey(const FileUploadTaskInfo& progress) {
+        return progress.localFilePath + "\n" + progress.s3ObjectKey;
+    }
+
+    // Summarize a dataId and copy the uploads in [uploadOffset, uploadOffset + uploadLimit)
+    // changedSince: only copy uploads whose status version is above it (0 = all of them)
+    // Assumes upload_data_map_mutex_ is held
+    void collectStatusInternal(const String& dataId, size_t uploadOffset, size_t uploadLimit,
+                               DataIdStatusBatchEntry& entry, unsigned long long changedSince = 0) const;
+
+    // Resolve a handle to a live task or a restored copy of an archived one
+    // Assumes upload_data_map_mutex_ is held
+    std::shared_ptr<FileUploadTaskInfo> resolveHandleInternal(UploadHandle handle) const;
+
+    // Remove an upload (live or archived) from every index
+    // Assumes upload_data_map_mutex_ is held
+    void eraseUploadInternal(UploadHandle handle);
+
 public:
-    // Get total number of uploads
+    // Get total number of uploads (live and archived)
     size_t getTotalUploads() const {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
-        return uploads_.size();
+        return uploadHandles_.size();
     }
     
     // Get number of pending uploads
@@ -279,11 +835,12 @@ public:
     size_t getUnfinishedUploads() const {
         std::lock_guard<std::mutex> lock(upload_data_map_mutex_);
         size_t count = 0;
-        for (const auto& pair : uploads_) {
-            if (pair.second->status != CONFIRM_SUCCESS) {
+        uploadHandles_.forEach([&count](UploadHandle, const UploadSlot& slot) {
+            UploadStatus status = slot.live ? slot.live->status : static_cast<UploadStatus>(slot.archived.status);
+            if (status != CONFIRM_SUCCESS) {
                 count++;
             }
-        }
+        });
         return count;
     }
     
@@ -291,7 +848,7 @@ public:
     // Enqueue an upload ID to the queue
     void enqueueUpload(const String& uploadId) {
         std::lock_guard<std::mutex> lock(queueMutex_);
-        uploadQueue_.push(uploadId);
+        uploadQueue_.push_back(uploadId);
     }
     
     // Dequeue an upload ID from the queue (returns empty string if queue is empty)
@@ -301,7 +858,7 @@ public:
             return "";
         }
         String uploadId = uploadQueue_.front();
-        uploadQueue_.pop();
+        uploadQueue_.pop_front();
         return uploadId;
     }
     
@@ -342,26 +899,41 @@ public:
             return "";
         }
         String uploadId = uploadQueue_.front();
-        uploadQueue_.pop();
+        uploadQueue_.pop_front();
         return uploadId;
     }
+
+    // Upload IDs at the head of the queue (up to count), without dequeuing them
+    std::vector<String> peekQueuedUploadsInternal(size_t count) const {
+        size_t size = (std::min)(count, uploadQueue_.size());
+        return std::vector<String>(uploadQueue_.begin(), uploadQueue_.begin() + size);
+    }
 };
 
 // Global variables (extern declarations)
-extern bool g_isInitialized;
+extern std::atomic<bool> g_isInitialized;
 extern Aws::SDKOptions g_options;
 
-// HippoClient credentials
-extern String g_apiUrl;
-extern String g_email;
-extern String g_password;
-
 // Common utility functions
 String create_response(int code, const String& message);
 
 // Upload ID helper functions
 String getUploadId(const String& dataId, long long timestamp);
 
+// Split uploadId ("dataId_timestamp") at the last separator
+// dataId may itself contain the separator; the timestamp suffix never does
+// Returns false if there is no separator or the timestamp is not numeric
+bool splitUploadId(const String& uploadId, String& dataId, long long& timestamp);
+
+// Re-enqueue unfinished uploads recovered from the upload journal
+// Runs once per opened journal; no-op until the SDK is initialized
+// Returns the number of uploads re-enqueued
+int ReplayUploadJournal();
+
+// Get local file size without opening the file
+// Returns -1 if the file does not exist or is a directory
+long long QueryLocalFileSize(const String& filePath);
+
 // Extract uploadDataName from S3 objectKey
 // objectKey format: "patient/patientId/source_data/dataId/uploadDataName/" or 
 //                   "patient/patientId/source_data/dataId/uploadDataName/filename"
@@ -378,11 +950,26 @@ extern "C" {
     S3UPLOAD_API int __stdcall FileExists(const char* filePath);
     S3UPLOAD_API long __stdcall GetS3FileSize(const char* filePath);
     S3UPLOAD_API const char* __stdcall SetCredential(const char* hippoApiUrl, const char* userName, const char* password);
+    S3UPLOAD_API const char* __stdcall SetCredentialAsync(const char* hippoApiUrl, const char* userName,
+                                                          const char* password);
+    S3UPLOAD_API const char* __stdcall WaitForCredential(int timeoutMs);
 }
 
 // Internal function declarations
 const char* InitializeAwsSDK();
 
+// Readiness barrier of SetCredentialAsync
+// True while a background initialization has not set the credentials yet
+bool IsSdkInitializing();
+
+// True once the SDK is initialized and no background initialization is pending
+bool IsSdkReady();
+
+// Wait until pending background initializations have set the credentials
+// timeoutMs < 0 waits indefinitely
+// Returns true if the SDK is initialized afterwards (false on timeout or failed initialization)
+bool WaitForSdkReady(long timeoutMs);
+
 // Backend API confirmation function
 bool ConfirmUploadRawFile(const String& dataId, 
                          const String& uploadDataName, const String& patientId, 
@@ -393,6 +980,17 @@ bool ConfirmIncrementalUploadFile(const String& dataId,
                                   const String& uploadDataName, const String& patientId,
                                   long long uploadFileSizeBytes, const String& s3ObjectKey);
 
+// Start an incremental confirmation without waiting for the backend
+// Pass the response to FinishIncrementalUploadConfirmation (from the same thread)
+HippoClient::AsyncResponse BeginIncrementalUploadConfirmation(const String& dataId,
+                                                              const String& uploadDataName, const String& patientId,
+                                                              long long uploadFileSizeBytes, const String& s3ObjectKey);
+
+// Wait for an incremental confirmation started by BeginIncrementalUploadConfirmation
+// Returns the same result as ConfirmIncrementalUploadFile
+bool FinishIncrementalUploadConfirmation(HippoClient::AsyncResponse& response,
+                                         const String& dataId, const String& s3ObjectKey);
+
 // S3 client creation helper
 Aws::S3::S3Client createS3Client(const String& accessKey,
                                 const String& secretKey,
@@ -0,0 +1,317 @@
+#include "S3Common.h"
+#include "credential_cache.h"
+#include <wincrypt.h>
+
+using json = nlohmann::json;
+
+// FNV-1a hash of the account key, used to name its file without exposing the email
+static std::string accountFileTag(const std::string& accountKey) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (unsigned char c : accountKey) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    static const char hexDigits[] = "0123456789abcdef";
+    std::string tag(16, '0');
+    for (int i = 15; i >= 0; --i) {
+        tag[i] = hexDigits[hash & 0xF];
+        hash >>= 4;
+    }
+    return tag;
+}
+
+// Decode base64url (JWT segments: '-' and '_' alphabet, no padding)
+// Returns false on characters outside the alphabet
+static bool decodeBase64Url(const std::string& text, std::string& out) {
+    out.clear();
+    unsigned int buffer = 0;
+    int bits = 0;
+    for (char c : text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a' + 26;
+        else if (c >= '0' && c <= '9') value = c - '0' + 52;
+        else if (c == '-' || c == '+') value = 62;
+        else if (c == '_' || c == '/') value = 63;
+        else if (c == '=') break;
+        else return false;
+
+        buffer = (buffer << 6) | static_cast<unsigned int>(value);
+        bits += 6;
+        if (bits >= 8) {
+            bits -= 8;
+            out += static_cast<char>((buffer >> bits) & 0xFF);
+        }
+    }
+    return true;
+}
+
+std::time_t jwtExpiration(const std::string& jwtToken) {
+    // header.payload.signature; only the payload is needed
+    size_t first = jwtToken.find('.');
+    size_t second = first == std::string::npos ? std::string::npos : jwtToken.find('.', first + 1);
+    if (second == std::string::npos) {
+        return 0;
+    }
+
+    std::string payload;
+    if (!decodeBase64Url(jwtToken.substr(first + 1, second - first - 1), payload)) {
+        return 0;
+    }
+    json claims = json::parse(payload, nullptr, false);
+    if (claims.is_discarded() || !claims.is_object() || !claims.contains("exp") || !claims["exp"].is_number()) {
+        return 0;
+    }
+    return static_cast<std::time_t>(claims["exp"].get<long long>());
+}
+
+// Expiration of a cached GetS3Credentials response, or 0 if it has none
+static std::time_t s3CredentialsExpiration(const json& credentials) {
+    try {
+        const std::string expiration = credentials.at("amazonTemporaryCredentials")
+                                                  .at("expirationTimestampSecondsInUTC").get<std::string>();
+        return static_cast<std::time_t>(std::stoll(expiration));
+    } catch (...) {
+        return 0;
+    }
+}
+
+// True if an entry expiring at expiration is still worth serving
+static bool isUsable(std::time_t expiration) {
+    return expiration > std::time(nullptr) + CREDENTIAL_CACHE_MIN_REMAINING_SECONDS;
+}
+
+bool CredentialCache::open(const std::string& directory) {
+    if (directory.empty()) {
+        return false;
+    }
+
+    // Create the directory if needed (parent directories must already exist)
+    CreateDirectoryA(directory.c_str(), nullptr);
+    DWORD attributes = GetFileAttributesA(directory.c_str());
+    if (attributes == INVALID_FILE_ATTRIBUTES || !(attributes & FILE_ATTRIBUTE_DIRECTORY)) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Cannot use credential cache directory: " << directory);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    directory_ = directory;
+    char lastChar = directory_[directory_.size() - 1];
+    if (lastChar != '\\' && lastChar != '/') {
+        directory_ += "\\";
+    }
+    enabled_ = true;
+    loadLocked();
+    AWS_LOGSTREAM_INFO("S3Upload", "Credential cache enabled: " << directory_);
+    return true;
+}
+
+void CredentialCache::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    enabled_ = false;
+    resetLocked();
+}
+
+bool CredentialCache::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+bool CredentialCache::selectAccount(const std::string& baseUrl, const std::string& account, const std::string& password) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string accountKey = baseUrl + "|" + account;
+    std::string entropy = accountKey + "|" + password;
+    if (accountKey != accountKey_ || entropy != entropy_) {
+        accountKey_ = accountKey;
+        entropy_ = entropy;
+        loadLocked();
+    }
+    return enabled_ && !jwtTaken_ && !jwtToken_.empty() && isUsable(jwtExpiration_);
+}
+
+bool CredentialCache::takeToken(std::string& jwtToken, std::string& hospitalId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || jwtTaken_ || jwtToken_.empty() || !isUsable(jwtExpiration_)) {
+        return false;
+    }
+    jwtTaken_ = true;
+    jwtToken = jwtToken_;
+    hospitalId = hospitalId_;
+    AWS_LOGSTREAM_INFO("S3Upload", "Using cached JWT (expires at " << jwtExpiration_ << ")");
+    return true;
+}
+
+void CredentialCache::storeToken(const std::string& jwtToken, const std::string& hospitalId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || accountKey_.empty()) {
+        return;
+    }
+    std::time_t expiration = jwtExpiration(jwtToken);
+    if (expiration == 0) {
+        // Without an "exp" claim the token's validity cannot be checked at startup
+        return;
+    }
+    jwtToken_ = jwtToken;
+    hospitalId_ = hospitalId;
+    jwtExpiration_ = expiration;
+    jwtTaken_ = true;
+    saveLocked();
+}
+
+void CredentialCache::clearToken() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || jwtToken_.empty()) {
+        return;
+    }
+    jwtToken_.clear();
+    hospitalId_.clear();
+    jwtExpiration_ = 0;
+    saveLocked();
+}
+
+bool CredentialCache::takeS3Credentials(const std::string& patientId, json& credentials) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || s3Taken_.count(patientId) != 0) {
+        return false;
+    }
+    auto it = s3Credentials_.find(patientId);
+    if (it == s3Credentials_.end() || !isUsable(s3CredentialsExpiration(it->second))) {
+        return false;
+    }
+    s3Taken_.insert(patientId);
+    credentials = it->second;
+    AWS_LOGSTREAM_INFO("S3Upload", "Using cached S3 credentials for patientId: " << patientId);
+    return true;
+}
+
+void CredentialCache::storeS3Credentials(const std::string& patientId, const json& credentials) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!enabled_ || accountKey_.empty() || s3CredentialsExpiration(credentials) == 0) {
+        return;
+    }
+    s3Credentials_[patientId] = credentials;
+    s3Taken_.insert(patientId);
+    saveLocked();
+}
+
+std::string CredentialCache::filePathLocked() const {
+    if (!enabled_ || accountKey_.empty()) {
+        return "";
+    }
+    return directory_ + CREDENTIAL_CACHE_FILE_PREFIX + accountFileTag(accountKey_) + ".bin";
+}
+
+void CredentialCache::resetLocked() {
+    jwtToken_.clear();
+    hospitalId_.clear();
+    jwtExpiration_ = 0;
+    jwtTaken_ = false;
+    s3Credentials_.clear();
+    s3Taken_.clear();
+}
+
+void CredentialCache::loadLocked() {
+    resetLocked();
+    std::string path = filePathLocked();
+    if (path.empty()) {
+        return;
+    }
+
+    // Step 1: Read the encrypted file
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        return;
+    }
+    std::string encrypted((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (encrypted.empty()) {
+        return;
+    }
+
+    // Step 2: Decrypt (fails for another Windows user, account or password)
+    DATA_BLOB input = { static_cast<DWORD>(encrypted.size()), reinterpret_cast<BYTE*>(&encrypted[0]) };
+    DATA_BLOB entropy = { static_cast<DWORD>(entropy_.size()), reinterpret_cast<BYTE*>(&entropy_[0]) };
+    DATA_BLOB output = { 0, nullptr };
+    if (!CryptUnprotectData(&input, nullptr, &entropy, nullptr, nullptr, CRYPTPROTECT_UI_FORBIDDEN, &output)) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Credential cache does not match the account, ignoring it");
+        return;
+    }
+    std::string plain(reinterpret_cast<const char*>(output.pbData), output.cbData);
+    SecureZeroMemory(output.pbData, output.cbData);
+    LocalFree(output.pbData);
+
+    // Step 3: Take the entries that are still usable
+    json contents = json::parse(plain, nullptr, false);
+    SecureZeroMemory(&plain[0], plain.size());
+    if (contents.is_discarded() || !contents.is_object()) {
+        return;
+    }
+    if (contents.contains("jwt") && contents["jwt"].is_string()) {
+        std::string jwtToken = contents["jwt"].get<std::string>();
+        std::time_t expiration = jwtExpiration(jwtToken);
+        if (isUsable(expiration) && contents.contains("hospitalId") && contents["hospitalId"].is_string()) {
+            jwtToken_ = jwtToken;
+            hospitalId_ = contents["hospitalId"].get<std::string>();
+            jwtExpiration_ = expiration;
+        }
+    }
+    if (contents.contains("s3") && contents["s3"].is_object()) {
+        for (auto it = contents["s3"].begin(); it != contents["s3"].end(); ++it) {
+            if (isUsable(s3CredentialsExpiration(it.value()))) {
+                s3Credentials_[it.key()] = it.value();
+            }
+        }
+    }
+    AWS_LOGSTREAM_INFO("S3Upload", "Credential cache loaded - JWT: " << (jwtToken_.empty() ? "none" : "valid")
+                      << ", S3 credentials: " << s3Credentials_.size());
+}
+
+void CredentialCache::saveLocked() {
+    std::string path = filePathLocked();
+    if (path.empty()) {
+        return;
+    }
+
+    // Step 1: Serialize the entries that are still usable
+    json contents = json::object();
+    if (!jwtToken_.empty()) {
+        contents["jwt"] = jwtToken_;
+        contents["jwtExpiration"] = static_cast<long long>(jwtExpiration_);
+        contents["hospitalId"] = hospitalId_;
+    }
+    json s3 = json::object();
+    for (const auto& entry : s3Credentials_) {
+        if (isUsable(s3CredentialsExpiration(entry.second))) {
+            s3[entry.first] = entry.second;
+        }
+    }
+    contents["s3"] = s3;
+    std::string plain = contents.dump();
+
+    // Step 2: Encrypt for the current Windows user with the account as entropy
+    DATA_BLOB input = { static_cast<DWORD>(plain.size()), reinterpret_cast<BYTE*>(&plain[0]) };
+    DATA_BLOB entropy = { static_cast<DWORD>(entropy_.size()), reinterpret_cast<BYTE*>(&entropy_[0]) };
+    DATA_BLOB output = { 0, nullptr };
+    BOOL protectedOk = CryptProtectData(&input, L"HippoCredentialCache", &entropy, nullptr, nullptr,
+                                        CRYPTPROTECT_UI_FORBIDDEN, &output);
+    SecureZeroMemory(&plain[0], plain.size());
+    if (!protectedOk) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Cannot encrypt credential cache");
+        return;
+    }
+
+    // Step 3: Write a temporary file and move it over the old one
+    std::string tempPath = path + ".tmp";
+    bool written = false;
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        if (file.is_open()) {
+            file.write(reinterpret_cast<const char*>(output.pbData), output.cbData);
+            written = file.good();
+        }
+    }
+    LocalFree(output.pbData);
+    if (!written || !MoveFileExA(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+        DeleteFileA(tempPath.c_str());
+        AWS_LOGSTREAM_WARN("S3Upload", "Cannot write credential cache: " << path);
+    }
+}
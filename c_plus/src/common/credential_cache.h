@@ -0,0 +1,106 @@
+#ifndef CREDENTIAL_CACHE_H
+#define CREDENTIAL_CACHE_H
+
+#include <ctime>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
+
+// Cached credentials are only used while at least this many seconds remain
+// (the JWT to avoid 401 retries, S3 credentials to stay clear of the client's refresh margin)
+static const std::time_t CREDENTIAL_CACHE_MIN_REMAINING_SECONDS = 900;
+// Cache file name prefix inside the configured directory (followed by a hash of the account)
+static const char* const CREDENTIAL_CACHE_FILE_PREFIX = "credential_cache_";
+
+// Warm-start cache of the HippoClient JWT and S3 credentials (EnableCredentialCache)
+// Lets a restarted process skip Login and the first GetS3Credentials per patient.
+//
+// One file per account (API URL + email). The contents are a JSON document encrypted with
+// DPAPI (CryptProtectData, current user scope); the account and password are passed as
+// additional entropy, so a file only decrypts for the same Windows user, account and
+// password. A file that does not decrypt or parse is treated as empty and overwritten.
+//   {"jwt":...,"jwtExpiration":N,"hospitalId":...,"s3":{"<patientId>":<GetS3Credentials response>,...}}
+//
+// Cached entries are served once per process (warm start only): later logins and credential
+// fetches go to the server, and their results replace the cached entries.
+class CredentialCache {
+public:
+    // Get singleton instance of the cache
+    static CredentialCache& getInstance() {
+        static CredentialCache instance;
+        return instance;
+    }
+
+    // Store the cache in directory and load the file of the selected account (if any)
+    // Returns false if the directory cannot be created
+    bool open(const std::string& directory);
+
+    // Stop using the cache (the file is kept)
+    void close();
+
+    // True while the cache is open
+    bool isEnabled() const;
+
+    // Switch to an account (called by SetCredential) and load its cached entries
+    // Returns true if an unexpired JWT is available for it
+    bool selectAccount(const std::string& baseUrl, const std::string& account, const std::string& password);
+
+    // Take the cached JWT and hospital ID of the selected account
+    // Returns false if there is none (or it expires within CREDENTIAL_CACHE_MIN_REMAINING_SECONDS)
+    bool takeToken(std::string& jwtToken, std::string& hospitalId);
+
+    // Remember the JWT of a successful login
+    void storeToken(const std::string& jwtToken, const std::string& hospitalId);
+
+    // Forget the JWT (e.g. the server rejected it)
+    void clearToken();
+
+    // Take the cached GetS3Credentials response of a patient
+    // Returns false if there is none (or it expires within CREDENTIAL_CACHE_MIN_REMAINING_SECONDS)
+    bool takeS3Credentials(const std::string& patientId, nlohmann::json& credentials);
+
+    // Remember a GetS3Credentials response
+    void storeS3Credentials(const std::string& patientId, const nlohmann::json& credentials);
+
+private:
+    CredentialCache() : enabled_(false), jwtExpiration_(0), jwtTaken_(false) {}
+    ~CredentialCache() = default;
+    CredentialCache(const CredentialCache&) = delete;
+    CredentialCache& operator=(const CredentialCache&) = delete;
+
+    // Read and decrypt the file of the selected account, dropping expired entries
+    // Assumes mutex_ is held
+    void loadLocked();
+
+    // Encrypt and write the entries to the file of the selected account
+    // Written to a temporary file first and moved over the old one
+    // Assumes mutex_ is held
+    void saveLocked();
+
+    // Path of the selected account's file ("" if the cache is closed or no account is selected)
+    // Assumes mutex_ is held
+    std::string filePathLocked() const;
+
+    // Drop all cached entries (in memory only)
+    // Assumes mutex_ is held
+    void resetLocked();
+
+    mutable std::mutex mutex_;                              // Protects all members
+    bool enabled_;                                          // Cache is open
+    std::string directory_;                                 // Directory of the cache files
+    std::string accountKey_;                                // API URL + "|" + email of the selected account
+    std::string entropy_;                                   // DPAPI entropy of the selected account
+    std::string jwtToken_;                                  // Cached JWT ("" if none)
+    std::string hospitalId_;                                // Hospital ID returned with the JWT
+    std::time_t jwtExpiration_;                             // "exp" claim of the JWT
+    bool jwtTaken_;                                         // JWT already served to this process
+    std::unordered_map<std::string, nlohmann::json> s3Credentials_;  // Patient ID -> GetS3Credentials response
+    std::unordered_set<std::string> s3Taken_;               // Patient IDs already served to this process
+};
+
+// Expiration ("exp" claim, Unix seconds) of a JWT, or 0 if it cannot be decoded
+std::time_t jwtExpiration(const std::string& jwtToken);
+
+#endif // CREDENTIAL_CACHE_H
@@ -0,0 +1,137 @@
+#include "json_writer.h"
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define JSON_WRITER_SSE2 1
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#elif defined(_M_ARM64) || defined(__aarch64__)
+#define JSON_WRITER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// True if the byte cannot appear unescaped inside a JSON string
+static inline bool needsJsonEscape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\';
+}
+
+#ifdef JSON_WRITER_SSE2
+// Index of the lowest set bit of a non-zero mask
+static inline unsigned lowestSetBit(unsigned mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<unsigned>(index);
+#else
+    return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+size_t jsonPlainPrefixLength(const char* data, size_t size) {
+    size_t i = 0;
+
+#if defined(JSON_WRITER_SSE2)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    for (; i + 16 <= size; i += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        // max(c, 0x1F) == 0x1F  <=>  c <= 0x1F (unsigned)
+        __m128i special = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+            _mm_cmpeq_epi8(_mm_max_epu8(chunk, controlMax), controlMax));
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(special));
+        if (mask != 0) {
+            return i + lowestSetBit(mask);
+        }
+    }
+#elif defined(JSON_WRITER_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t controlEnd = vdupq_n_u8(0x20);
+    for (; i + 16 <= size; i += 16) {
+        uint8x16_t chunk = vld1q_u8(reinterpret_cast<const uint8_t*>(data + i));
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)),
+                                      vcltq_u8(chunk, controlEnd));
+        if (vmaxvq_u8(special) != 0) {
+            // Locate the byte within this chunk
+            break;
+        }
+    }
+#endif
+
+    for (; i < size; ++i) {
+        if (needsJsonEscape(static_cast<unsigned char>(data[i]))) {
+            return i;
+        }
+    }
+    return size;
+}
+
+void appendJsonEscaped(std::string& out, const char* data, size_t size) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    size_t position = 0;
+    while (position < size) {
+        // Step 1: Copy the clean run in one go
+        size_t plain = jsonPlainPrefixLength(data + position, size - position);
+        out.append(data + position, plain);
+        position += plain;
+        if (position >= size) {
+            break;
+        }
+
+        // Step 2: Escape the special character
+        unsigned char c = static_cast<unsigned char>(data[position++]);
+        switch (c) {
+            case '"': out.append("\\\"", 2); break;
+            case '\\': out.append("\\\\", 2); break;
+            case '\b': out.append("\\b", 2); break;
+            case '\f': out.append("\\f", 2); break;
+            case '\n': out.append("\\n", 2); break;
+            case '\r': out.append("\\r", 2); break;
+            case '\t': out.append("\\t", 2); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hexDigits[c >> 4], hexDigits[c & 0xF] };
+                out.append(escaped, 6);
+                break;
+            }
+        }
+    }
+}
+
+void appendJsonNumber(std::string& out, unsigned long long value) {
+    // Two digits per step from a lookup table, written backwards into a stack buffer
+    static const char digitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+    char digits[20];
+    char* end = digits + sizeof(digits);
+    char* cursor = end;
+    while (value >= 100) {
+        unsigned pair = static_cast<unsigned>(value % 100) * 2;
+        value /= 100;
+        *--cursor = digitPairs[pair + 1];
+        *--cursor = digitPairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = static_cast<unsigned>(value) * 2;
+        *--cursor = digitPairs[pair + 1];
+        *--cursor = digitPairs[pair];
+    } else {
+        *--cursor = static_cast<char>('0' + value);
+    }
+    out.append(cursor, static_cast<size_t>(end - cursor));
+}
+
+void appendJsonNumber(std::string& out, long long value) {
+    if (value < 0) {
+        out += '-';
+        // Negate in unsigned arithmetic so LLONG_MIN does not overflow
+        appendJsonNumber(out, 0ULL - static_cast<unsigned long long>(value));
+    } else {
+        appendJsonNumber(out, static_cast<unsigned long long>(value));
+    }
+}
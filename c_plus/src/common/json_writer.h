@@ -0,0 +1,159 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+// Length of the leading part of data that can be copied into a JSON string unchanged
+// (stops at the first '"', '\\' or control character). Scans 16 bytes at a time with
+// SSE2 on x86/x64 and NEON on ARM64, byte by byte elsewhere.
+size_t jsonPlainPrefixLength(const char* data, size_t size);
+
+// Append data to out as the contents of a JSON string (without the surrounding quotes)
+// Clean runs are copied in bulk; control characters become \b \f \n \r \t or \u00XX
+void appendJsonEscaped(std::string& out, const char* data, size_t size);
+
+// Append the decimal representation of a number to out
+void appendJsonNumber(std::string& out, long long value);
+void appendJsonNumber(std::string& out, unsigned long long value);
+
+// Streaming JSON writer appending to a caller-owned string
+// Commas between members and array elements are inserted automatically, so callers only
+// open/close containers and write keys and values. No temporaries are created: strings are
+// escaped and numbers formatted directly into the output, so reusing the output string
+// (see scratchBuffer) makes repeated serialization allocation-free once its capacity has grown.
+class JsonWriter {
+public:
+    explicit JsonWriter(std::string& out) : out_(out), depth_(0), afterKey_(false) {
+        needComma_[0] = false;
+    }
+
+    // Per-thread buffer that keeps its capacity between calls (returned empty)
+    static std::string& scratchBuffer() {
+        static thread_local std::string buffer;
+        buffer.clear();
+        return buffer;
+    }
+
+    JsonWriter& beginObject() {
+        open('{');
+        return *this;
+    }
+
+    JsonWriter& endObject() {
+        close('}');
+        return *this;
+    }
+
+    JsonWriter& beginArray() {
+        open('[');
+        return *this;
+    }
+
+    JsonWriter& endArray() {
+        close(']');
+        return *this;
+    }
+
+    // Write a member name; name must not need escaping (i.e. a literal identifier)
+    JsonWriter& key(const char* name) {
+        separate();
+        out_ += '"';
+        out_ += name;
+        out_ += "\":";
+        afterKey_ = true;
+        return *this;
+    }
+
+    JsonWriter& value(const std::string& text) {
+        return value(text.data(), text.size());
+    }
+
+    JsonWriter& value(const char* text) {
+        return value(text, strlen(text));
+    }
+
+    JsonWriter& value(const char* text, size_t size) {
+        separate();
+        out_ += '"';
+        appendJsonEscaped(out_, text, size);
+        out_ += '"';
+        return *this;
+    }
+
+    JsonWriter& value(int number) {
+        return value(static_cast<long long>(number));
+    }
+
+    JsonWriter& value(long long number) {
+        separate();
+        appendJsonNumber(out_, number);
+        return *this;
+    }
+
+    JsonWriter& value(unsigned long long number) {
+        separate();
+        appendJsonNumber(out_, number);
+        return *this;
+    }
+
+    JsonWriter& value(bool flag) {
+        separate();
+        out_ += flag ? "true" : "false";
+        return *this;
+    }
+
+    // Shorthand for key(name).value(v)
+    template <typename T>
+    JsonWriter& field(const char* name, const T& v) {
+        key(name);
+        return value(v);
+    }
+
+    // Write an already serialized JSON value
+    JsonWriter& rawValue(const std::string& json) {
+        separate();
+        out_ += json;
+        return *this;
+    }
+
+private:
+    // Maximum nesting depth tracked for comma insertion
+    static const int MAX_DEPTH = 16;
+
+    // Emit a comma if a sibling precedes the next member/element
+    void separate() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        if (needComma_[depth_]) {
+            out_ += ',';
+        }
+        needComma_[depth_] = true;
+    }
+
+    void open(char bracket) {
+        separate();
+        out_ += bracket;
+        if (depth_ < MAX_DEPTH - 1) {
+            ++depth_;
+        }
+        needComma_[depth_] = false;
+    }
+
+    void close(char bracket) {
+        out_ += bracket;
+        if (depth_ > 0) {
+            --depth_;
+        }
+    }
+
+    std::string& out_;
+    int depth_;                    // Current container depth (0 = top level)
+    bool afterKey_;                // A key was written and its value is pending
+    bool needComma_[MAX_DEPTH];    // Per depth: an element was already written
+};
+
+#endif // JSON_WRITER_H
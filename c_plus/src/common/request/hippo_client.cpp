@@ -1,4 +1,5 @@
 #include "hippo_client.h"
+#include "../credential_cache.h"
 #include <iostream>
 #include <string>
 #include <curl/curl.h>
@@ -6,6 +7,11 @@
 #include <thread>
 #include <chrono>
 #include <stdexcept>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
 
 using json = nlohmann::json;
 
@@ -15,10 +21,25 @@ std::string HippoClient::account_;
 std::string HippoClient::password_;
 std::string HippoClient::jwt_token_;
 std::string HippoClient::hospital_id_;
+std::time_t HippoClient::jwt_expiration_ = 0;
+std::mutex HippoClient::token_mutex_;
+std::condition_variable HippoClient::login_cv_;
+bool HippoClient::login_in_progress_ = false;
+unsigned long long HippoClient::logins_finished_ = 0;
+bool HippoClient::last_login_succeeded_ = false;
+std::string HippoClient::last_login_error_;
+const std::time_t HippoClient::JWT_RENEWAL_MARGIN_SECONDS = 300;
 const std::string HippoClient::HTTP_STATUS_UNAUTHORIZED = "401";
 
 // Public interface
 void HippoClient::Init(const std::string& baseUrl, const std::string& account, const std::string& password) {
+    std::lock_guard<std::mutex> lock(token_mutex_);
+    // A token issued for another account must not be reused
+    if (baseUrl != base_url_ || account != account_) {
+        jwt_token_.clear();
+        hospital_id_.clear();
+        jwt_expiration_ = 0;
+    }
     base_url_ = baseUrl;
     account_ = account;
     password_ = password;
@@ -39,7 +60,19 @@ json HippoClient::ConfirmIncrementalUploadFile(const json& payload) {
     return response;
 }
 
+HippoClient::AsyncResponse HippoClient::ConfirmIncrementalUploadFileAsync(const json& payload) {
+    std::string url = base_url_ + "/hippo/thirdParty/file/confirmIncrementalUploadFile";
+    return RequestWithTokenAsync("POST", url, payload);
+}
+
 json HippoClient::GetS3Credentials(const std::string& patientId) {
+    // Warm start: the first request for a patient may be served from the credential cache
+    json cached;
+    if (CredentialCache::getInstance().takeS3Credentials(patientId, cached)) {
+        std::cout << "[get_s3_credentials] using cached credentials for patientId=" << patientId << std::endl;
+        return cached;
+    }
+
     std::string url = base_url_ + "/hippo/thirdParty/file/getS3Credentials";
     json payload = {
         {"keyId", patientId},
@@ -49,11 +82,12 @@ json HippoClient::GetS3Credentials(const std::string& patientId) {
 
     json response = RequestWithToken("POST", url, payload);
     std::cout << "[get_s3_credentials] response:\n" << response << std::endl;
+    CredentialCache::getInstance().storeS3Credentials(patientId, response);
     return response;
 }
 
 // Private methods
-void HippoClient::Login() {
+void HippoClient::Login(std::string& jwt_token, std::string& hospital_id) {
     std::string url = base_url_ + "/hippo/thirdParty/user/login";
     json payload = {
         {"userMessage", {{"email", account_}}},
@@ -66,33 +100,119 @@ void HippoClient::Login() {
         throw std::runtime_error("Login failed: missing jwtToken in response");
     }
 
-    jwt_token_ = response["jwtToken"];
+    jwt_token = response["jwtToken"];
 
     // Extract hospital ID from user info
     if (!response.contains("userInfo") || !response["userInfo"].contains("hospitalId")) {
         throw std::runtime_error("Login failed: missing hospitalId in response");
     }
-    hospital_id_ = response["userInfo"]["hospitalId"].get<std::string>();
+    hospital_id = response["userInfo"]["hospitalId"].get<std::string>();
 
-    std::cout << "[HippoClient] Login success, jwt_token=" << jwt_token_
-              << ", hospital_id=" << hospital_id_ << std::endl;
+    std::cout << "[HippoClient] Login success, jwt_token=" << jwt_token
+              << ", hospital_id=" << hospital_id << std::endl;
 }
 
 std::string HippoClient::GetToken() {
-    if (jwt_token_.empty()) Login();
+    std::unique_lock<std::mutex> lock(token_mutex_);
+
+    // Warm start: reuse the token of a previous process if it is still valid
+    if (jwt_token_.empty() && CredentialCache::getInstance().takeToken(jwt_token_, hospital_id_)) {
+        jwt_expiration_ = jwtExpiration(jwt_token_);
+        std::cout << "[HippoClient] Using cached jwt_token" << std::endl;
+    }
+
+    const std::time_t now = std::time(nullptr);
+    if (!jwt_token_.empty() && jwt_expiration_ != 0 && now >= jwt_expiration_) {
+        // Expired: requests would only come back with 401
+        jwt_token_.clear();
+        jwt_expiration_ = 0;
+    }
+
+    if (!jwt_token_.empty()) {
+        // Proactive renewal: one caller logs in ahead of expiry, the others keep using the current token
+        if (jwt_expiration_ != 0 && now > jwt_expiration_ - JWT_RENEWAL_MARGIN_SECONDS && !login_in_progress_) {
+            std::cout << "[HippoClient] jwt_token expires soon, renewing" << std::endl;
+            std::string error;
+            if (!SingleFlightLogin(lock, 1, error)) {
+                std::cerr << "[HippoClient] Token renewal failed, keeping current token: " << error << std::endl;
+            }
+        }
+        if (!jwt_token_.empty()) {
+            return "Bearer " + jwt_token_;
+        }
+    }
+
+    // No token: log in, or wait for the login in flight
+    std::string error;
+    if (!SingleFlightLogin(lock, 1, error)) {
+        throw std::runtime_error(error);
+    }
     return "Bearer " + jwt_token_;
 }
 
+void HippoClient::RenewRejectedToken(const std::string& rejected_token) {
+    std::unique_lock<std::mutex> lock(token_mutex_);
+
+    // Another request already replaced the rejected token (or a login for it is running)
+    if (!jwt_token_.empty() && "Bearer " + jwt_token_ != rejected_token) {
+        return;
+    }
+    if (!jwt_token_.empty()) {
+        jwt_token_.clear();
+        jwt_expiration_ = 0;
+        CredentialCache::getInstance().clearToken();
+    }
+
+    std::string error;
+    if (!SingleFlightLogin(lock, 3, error)) {
+        throw std::runtime_error("Login failed after retries, cannot refresh token");
+    }
+}
+
+bool HippoClient::SingleFlightLogin(std::unique_lock<std::mutex>& lock, int maxLoginRetries, std::string& error) {
+    // Step 1: Share the outcome of a login already in flight
+    if (login_in_progress_) {
+        const unsigned long long finished = logins_finished_;
+        login_cv_.wait(lock, [finished] { return logins_finished_ != finished; });
+        error = last_login_error_;
+        return last_login_succeeded_;
+    }
+
+    // Step 2: Log in without holding the lock
+    login_in_progress_ = true;
+    lock.unlock();
+    std::string jwt_token;
+    std::string hospital_id;
+    bool succeeded = LoginWithRetries(maxLoginRetries, jwt_token, hospital_id, error);
+    lock.lock();
+
+    // Step 3: Install the token and wake the callers waiting for it
+    if (succeeded) {
+        jwt_token_ = jwt_token;
+        hospital_id_ = hospital_id;
+        jwt_expiration_ = jwtExpiration(jwt_token);
+        CredentialCache::getInstance().storeToken(jwt_token_, hospital_id_);
+    }
+    login_in_progress_ = false;
+    ++logins_finished_;
+    last_login_succeeded_ = succeeded;
+    last_login_error_ = error;
+    login_cv_.notify_all();
+    return succeeded;
+}
+
 // Login retry mechanism
-bool HippoClient::LoginWithRetries(int maxLoginRetries) {
+bool HippoClient::LoginWithRetries(int maxLoginRetries, std::string& jwt_token, std::string& hospital_id,
+                                   std::string& error) {
     int attempt = 0;
     while (attempt < maxLoginRetries) {
         try {
-            Login(); // Attempt login
+            Login(jwt_token, hospital_id); // Attempt login
             return true; // Login successful
-        } catch (const std::exception& error) {
+        } catch (const std::exception& login_error) {
+            error = login_error.what();
             std::cerr << "[HippoClient] Login attempt " << (attempt + 1)
-                      << " failed: " << error.what() << std::endl;
+                      << " failed: " << error << std::endl;
             attempt++;
 
             // Exponential backoff: 2^attempt seconds (2s, 4s, 8s, ...)
@@ -114,8 +234,9 @@ json HippoClient::RequestWithToken(const std::string& method,
                                    long timeoutSeconds) {
     int attempt = 0;
     while (attempt < maxRetries) {
+        std::string token;
         try {
-            std::string token = GetToken();
+            token = GetToken();
             std::cout << "[HippoClient] Making request to: " << url << std::endl;
             json response = HttpRequest(method, url, payload, token, timeoutSeconds);
             return response;
@@ -127,10 +248,8 @@ json HippoClient::RequestWithToken(const std::string& method,
             // Check if error is due to expired/invalid token (401 Unauthorized)
             if (error_message.find(HTTP_STATUS_UNAUTHORIZED) != std::string::npos) {
                 std::cerr << "[HippoClient] Token expired, attempting re-login..." << std::endl;
-                jwt_token_.clear();
-                if (!LoginWithRetries()) {
-                    throw std::runtime_error("Login failed after retries, cannot refresh token");
-                }
+                // Single-flight: concurrent requests rejected with the same token share one login
+                RenewRejectedToken(token);
                 // Continue to retry the request with new token (don't increment attempt)
                 continue;
             }
@@ -167,83 +286,225 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
 }
 
 /**
- * Unified HTTP request function (supports GET/POST/PUT/DELETE).
- * Performs HTTP request using libcurl with SSL verification, timeout handling,
- * and automatic JSON parsing. Returns the "data" field if present, otherwise
- * returns the full JSON response.
- * @param method  HTTP method, e.g., "GET", "POST", "PUT", "DELETE"
- * @param url     Full request URL
- * @param payload JSON payload (only used for POST/PUT requests)
- * @param token   Authorization token (optional, format: "Bearer <token>")
- * @param timeoutSeconds Total timeout in seconds (default: 30)
- * @return json   Parsed JSON response (returns "data" field if present, otherwise full response)
+ * Pool of reusable curl easy handles for one API base URL.
+ * Each easy handle keeps its own connection cache across curl_easy_reset, so a request
+ * on a pooled handle (login, credential fetches, confirmations) reuses its kept-alive
+ * connection instead of connecting and handshaking again. All handles are attached to
+ * one curl share handle holding the DNS cache and TLS sessions, so a handle opening a
+ * new connection skips the lookup and resumes the TLS session. The connection cache
+ * itself is not shared: libcurl does not support sharing it between threads, and the
+ * handles are used concurrently. Idle handles also keep their header list for the last token.
+ * Thread-safe: the pool and the share handle are guarded by mutexes.
  */
-json HippoClient::HttpRequest(const std::string& method,
-                              const std::string& url,
-                              const json& payload,
-                              const std::string& token,
-                              long timeoutSeconds) {
-    // 1. Initialize CURL handle
-    CURL* curl_handle = curl_easy_init();
-    if (!curl_handle) {
-        throw std::runtime_error("Failed to initialize curl handle");
+class CurlHandlePool {
+public:
+    /// Maximum number of idle handles kept
+    static const size_t kMaxIdleHandles = 4;
+
+    /**
+     * A pooled easy handle together with its cached header list.
+     */
+    struct Handle {
+        CURL* curl;                  ///< Easy handle (options are reset between requests)
+        curl_slist* headers;         ///< Header list built for token
+        std::string token;           ///< Authorization token the header list was built for
+    };
+
+    /**
+     * Gets the pool of a base URL, creating it on first use.
+     * Pools are never destroyed, so no connection is torn down during DLL unload.
+     */
+    static CurlHandlePool& ForBaseUrl(const std::string& base_url) {
+        static std::mutex pools_mutex;
+        static auto* pools = new std::unordered_map<std::string, CurlHandlePool*>();
+        std::lock_guard<std::mutex> lock(pools_mutex);
+        CurlHandlePool*& pool = (*pools)[base_url];
+        if (!pool) {
+            pool = new CurlHandlePool();
+        }
+        return *pool;
     }
 
-    std::string response_string;         // Buffer to store server response
-    struct curl_slist* headers = nullptr; // HTTP header list
-    std::string payload_string;           // Serialized JSON payload (ensures scope)
+    /**
+     * Takes an idle handle (or creates one) with its options reset and the share attached.
+     * @return Handle, or a handle with curl == nullptr if curl_easy_init failed
+     */
+    Handle Acquire() {
+        Handle handle = { nullptr, nullptr, std::string() };
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!idle_.empty()) {
+                handle = idle_.back();
+                idle_.pop_back();
+            }
+        }
+        if (handle.curl) {
+            curl_easy_reset(handle.curl);
+        } else {
+            handle.curl = curl_easy_init();
+            if (!handle.curl) {
+                return handle;
+            }
+        }
+        if (share_) {
+            curl_easy_setopt(handle.curl, CURLOPT_SHARE, share_);
+        }
+        return handle;
+    }
+
+    /**
+     * Returns a handle to the pool (or frees it if enough handles are idle).
+     */
+    void Release(Handle& handle) {
+        if (!handle.curl) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (idle_.size() < kMaxIdleHandles) {
+                idle_.push_back(handle);
+                handle.curl = nullptr;
+                handle.headers = nullptr;
+                return;
+            }
+        }
+        curl_slist_free_all(handle.headers);
+        curl_easy_cleanup(handle.curl);
+        handle.curl = nullptr;
+        handle.headers = nullptr;
+    }
+
+private:
+    CurlHandlePool() : share_(curl_share_init()) {
+        if (!share_) {
+            return;
+        }
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, LockShare);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, UnlockShare);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
 
-    // 2. Construct HTTP headers
-    headers = curl_slist_append(headers, "Content-Type: application/json; charset=utf-8");
-    headers = curl_slist_append(headers, "Accept: application/json");
+    static void LockShare(CURL*, curl_lock_data data, curl_lock_access, void* user_pointer) {
+        static_cast<CurlHandlePool*>(user_pointer)->share_mutexes_[data].lock();
+    }
 
-    // 3. Add Authorization header if token is provided
-    if (!token.empty()) {
-        std::string auth_header = "Authorization: " + token;
-        headers = curl_slist_append(headers, auth_header.c_str());
+    static void UnlockShare(CURL*, curl_lock_data data, void* user_pointer) {
+        static_cast<CurlHandlePool*>(user_pointer)->share_mutexes_[data].unlock();
     }
 
-    // 4. Configure CURL options: URL, method, headers, and response handling
+    CURLSH* share_;                                   ///< Shared DNS cache and TLS sessions
+    std::mutex share_mutexes_[CURL_LOCK_DATA_LAST];   ///< One lock per shared data kind
+    std::vector<Handle> idle_;                        ///< Idle handles, most recently used last
+    std::mutex mutex_;                                ///< Protects idle_
+};
+
+/**
+ * Returns a pooled handle to its pool when the request scope ends.
+ */
+class CurlHandleLease {
+public:
+    CurlHandleLease(CurlHandlePool& pool) : pool_(pool), handle_(pool.Acquire()) {}
+    ~CurlHandleLease() { pool_.Release(handle_); }
+
+    CurlHandlePool::Handle& get() { return handle_; }
+
+private:
+    CurlHandleLease(const CurlHandleLease&) = delete;
+    CurlHandleLease& operator=(const CurlHandleLease&) = delete;
+
+    CurlHandlePool& pool_;
+    CurlHandlePool::Handle handle_;
+};
+
+/**
+ * Configure a pooled CURL handle for one request.
+ * Shared by the blocking (HttpRequest) and the multiplexed (HttpRequestAsync) path.
+ * @param pooled  Pooled handle (its header list is rebuilt only when the token changes)
+ * @param method  HTTP method, e.g., "GET", "POST", "PUT", "DELETE"
+ * @param url     Full request URL
+ * @param payload JSON payload (only used for POST/PUT requests)
+ * @param token   Authorization token (optional, format: "Bearer <token>")
+ * @param timeoutSeconds Total timeout in seconds
+ * @param response_string Buffer receiving the response body
+ */
+static void ConfigureCurlRequest(CurlHandlePool::Handle& pooled,
+                                 const std::string& method,
+                                 const std::string& url,
+                                 const json& payload,
+                                 const std::string& token,
+                                 long timeoutSeconds,
+                                 std::string* response_string) {
+    CURL* curl_handle = pooled.curl;
+
+    // 1. Construct HTTP headers (kept with the handle and rebuilt only when the token changes)
+    if (!pooled.headers || pooled.token != token) {
+        curl_slist_free_all(pooled.headers);
+        pooled.headers = nullptr;
+        pooled.headers = curl_slist_append(pooled.headers, "Content-Type: application/json; charset=utf-8");
+        pooled.headers = curl_slist_append(pooled.headers, "Accept: application/json");
+
+        // 2. Add Authorization header if token is provided
+        if (!token.empty()) {
+            std::string auth_header = "Authorization: " + token;
+            pooled.headers = curl_slist_append(pooled.headers, auth_header.c_str());
+        }
+        pooled.token = token;
+    }
+    struct curl_slist* headers = pooled.headers; // HTTP header list
+
+    // 3. Configure CURL options: URL, method, headers, and response handling
     curl_easy_setopt(curl_handle, CURLOPT_URL, url.c_str());
     curl_easy_setopt(curl_handle, CURLOPT_CUSTOMREQUEST, method.c_str());   // Supports GET/POST/PUT/DELETE
     curl_easy_setopt(curl_handle, CURLOPT_HTTPHEADER, headers);             // Set HTTP headers
     curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, WriteCallback);    // Response data callback
-    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, &response_string);     // Write response to buffer
+    curl_easy_setopt(curl_handle, CURLOPT_WRITEDATA, response_string);      // Write response to buffer
 
-    // 5. Security settings: enable HTTPS certificate verification (required in production)
+    // 4. Security settings: enable HTTPS certificate verification (required in production)
     curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYPEER, 1L); // Verify SSL certificate
     curl_easy_setopt(curl_handle, CURLOPT_SSL_VERIFYHOST, 2L); // Verify hostname matches certificate
 
-    // 6. Timeout settings (prevent long blocking)
+    // 5. Timeout settings (prevent long blocking)
     curl_easy_setopt(curl_handle, CURLOPT_TIMEOUT, timeoutSeconds);        // Total request timeout (configurable)
     curl_easy_setopt(curl_handle, CURLOPT_CONNECTTIMEOUT, 10L); // Connection timeout: 10 seconds
 
+    // Keep idle pooled connections alive between requests
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPIDLE, 30L);
+    curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPINTVL, 15L);
+
+    // 6. Prefer HTTP/2 over TLS (falls back to HTTP/1.1) so concurrent requests can share a
+    // connection; wait for a connection being set up rather than opening another one
+    curl_easy_setopt(curl_handle, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+    curl_easy_setopt(curl_handle, CURLOPT_PIPEWAIT, 1L);
+
     // 7. For POST/PUT requests, serialize JSON payload and attach to request body
     if (method == "POST" || method == "PUT") {
-        payload_string = payload.dump();
+        std::string payload_string = payload.dump();
         std::cout << "[DEBUG] Sending JSON payload: " << payload_string << std::endl;
 
         // Use COPYPOSTFIELDS to ensure libcurl copies data internally, avoiding dangling pointer issues
         curl_easy_setopt(curl_handle, CURLOPT_COPYPOSTFIELDS, payload_string.c_str());
     }
+}
 
-    // 8. Execute HTTP request
-    CURLcode curl_result = curl_easy_perform(curl_handle);
-
-    // 9. Retrieve HTTP status code from response
-    long http_status_code = 0;
-    curl_easy_getinfo(curl_handle, CURLINFO_RESPONSE_CODE, &http_status_code);
-
-    // 10. Free CURL resources (headers must be freed before cleanup)
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl_handle);
-
-    // 11. Check if CURL execution was successful
+/**
+ * Turn the outcome of a finished CURL transfer into the response JSON.
+ * Throws std::runtime_error on transfer errors, invalid JSON and non-200 status codes
+ * (a 401 error message contains "401" so that callers can renew the token).
+ * @param curl_result Result of the transfer
+ * @param http_status_code HTTP status code of the response
+ * @param response_string Response body
+ * @return json   Parsed JSON response (returns "data" field if present, otherwise full response)
+ */
+static json ParseHttpResponse(CURLcode curl_result, long http_status_code, const std::string& response_string) {
+    // 1. Check if CURL execution was successful
     if (curl_result != CURLE_OK) {
         throw std::runtime_error(std::string("CURL request failed: ") + curl_easy_strerror(curl_result));
     }
 
-    // 12. Parse response as JSON
+    // 2. Parse response as JSON
     json response_json;
     try {
         response_json = json::parse(response_string);
@@ -253,7 +514,7 @@ json HippoClient::HttpRequest(const std::string& method,
                                  "\nRaw response: " + response_string);
     }
 
-    // 13. Check HTTP status code and handle errors
+    // 3. Check HTTP status code and handle errors
     if (http_status_code == 401) {
         throw std::runtime_error("401 Unauthorized - Authentication token is invalid or expired");
     }
@@ -262,6 +523,303 @@ json HippoClient::HttpRequest(const std::string& method,
                                  " - Response: " + response_string);
     }
 
-    // 14. Return "data" field if present (API convention), otherwise return full JSON response
+    // 4. Return "data" field if present (API convention), otherwise return full JSON response
     return response_json.contains("data") ? response_json["data"] : response_json;
-}
\ No newline at end of file
+}
+
+/**
+ * Unified HTTP request function (supports GET/POST/PUT/DELETE).
+ * Performs HTTP request using libcurl with SSL verification, timeout handling,
+ * and automatic JSON parsing. Handles come from the base URL's CurlHandlePool, so
+ * connections are kept alive and reused across requests.
+ * Returns the "data" field if present, otherwise returns the full JSON response.
+ * @param method  HTTP method, e.g., "GET", "POST", "PUT", "DELETE"
+ * @param url     Full request URL
+ * @param payload JSON payload (only used for POST/PUT requests)
+ * @param token   Authorization token (optional, format: "Bearer <token>")
+ * @param timeoutSeconds Total timeout in seconds (default: 30)
+ * @return json   Parsed JSON response (returns "data" field if present, otherwise full response)
+ */
+json HippoClient::HttpRequest(const std::string& method,
+                              const std::string& url,
+                              const json& payload,
+                              const std::string& token,
+                              long timeoutSeconds) {
+    // 1. Take a pooled CURL handle (returned to the pool when the lease goes out of scope)
+    CurlHandleLease lease(CurlHandlePool::ForBaseUrl(base_url_));
+    CurlHandlePool::Handle& pooled = lease.get();
+    if (!pooled.curl) {
+        throw std::runtime_error("Failed to initialize curl handle");
+    }
+
+    // 2. Configure headers, options and payload
+    std::string response_string;         // Buffer to store server response
+    ConfigureCurlRequest(pooled, method, url, payload, token, timeoutSeconds, &response_string);
+
+    // 3. Execute HTTP request
+    CURLcode curl_result = curl_easy_perform(pooled.curl);
+
+    // 4. Retrieve HTTP status code from response
+    long http_status_code = 0;
+    curl_easy_getinfo(pooled.curl, CURLINFO_RESPONSE_CODE, &http_status_code);
+
+    // 5. CURL resources (handle, headers, connection) stay with the pool for the next request
+    return ParseHttpResponse(curl_result, http_status_code, response_string);
+}
+
+/**
+ * Send a HEAD request to url through a pool, leaving its connection kept alive in the pool.
+ * Any HTTP status counts as success; only the connection matters.
+ * @param pool Pool whose DNS cache, TLS sessions and connections are warmed
+ * @param url  Endpoint URL
+ * @return true if the transfer completed
+ */
+static bool WarmUpPooledConnection(CurlHandlePool& pool, const std::string& url) {
+    CurlHandleLease lease(pool);
+    CurlHandlePool::Handle& pooled = lease.get();
+    if (!pooled.curl) {
+        return false;
+    }
+
+    std::string response_string;
+    ConfigureCurlRequest(pooled, "HEAD", url, json::object(), "", 10L, &response_string);
+    curl_easy_setopt(pooled.curl, CURLOPT_CUSTOMREQUEST, nullptr);
+    curl_easy_setopt(pooled.curl, CURLOPT_NOBODY, 1L);
+    CURLcode curl_result = curl_easy_perform(pooled.curl);
+    if (curl_result != CURLE_OK) {
+        std::cerr << "[HippoClient] Warm-up of " << url << " failed: " << curl_easy_strerror(curl_result) << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool HippoClient::Prewarm() {
+    // 1. Open the API connection (the login below reuses it)
+    WarmUpPooledConnection(CurlHandlePool::ForBaseUrl(base_url_), base_url_);
+
+    // 2. Log in, or take the cached JWT
+    try {
+        GetToken();
+        return true;
+    } catch (const std::exception& error) {
+        std::cerr << "[HippoClient] Prewarm login failed: " << error.what() << std::endl;
+        return false;
+    }
+}
+
+/**
+ * A request handed to the CurlMultiLoop.
+ */
+struct AsyncCurlRequest {
+    CurlHandlePool* pool;                 ///< Pool the handle is returned to
+    CurlHandlePool::Handle handle;        ///< Configured easy handle
+    std::string response_string;          ///< Response body
+    std::promise<json> result;            ///< Fulfilled when the transfer finishes
+};
+
+/**
+ * Event loop running HippoClient's asynchronous requests on one curl multi handle.
+ * Requests to the same host are multiplexed as HTTP/2 streams over a single connection
+ * (HTTP/1.1 servers get one request per connection, still without a thread per request).
+ * A single loop thread is started on the first request and exits after
+ * kIdleTimeoutSeconds without requests; results are delivered through futures.
+ * Thread-safe.
+ */
+class CurlMultiLoop {
+public:
+    /// The loop thread exits after this long without requests
+    static const int kIdleTimeoutSeconds = 60;
+
+    /**
+     * Gets the process-wide loop (never destroyed, see CurlHandlePool::ForBaseUrl).
+     */
+    static CurlMultiLoop& Instance() {
+        static CurlMultiLoop* loop = new CurlMultiLoop();
+        return *loop;
+    }
+
+    /**
+     * Queue a configured request; its result is set when the transfer finishes.
+     */
+    void Submit(std::unique_ptr<AsyncCurlRequest> request) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted_.push_back(std::move(request));
+        if (!thread_running_) {
+            thread_running_ = true;
+            // Clean up old thread handle if any
+            if (thread_.joinable()) {
+                thread_.detach();
+            }
+            thread_ = std::thread(&CurlMultiLoop::Run, this);
+        } else {
+            curl_multi_wakeup(multi_);
+        }
+    }
+
+    /**
+     * True if the multi handle could be created.
+     */
+    bool IsAvailable() const {
+        return multi_ != nullptr;
+    }
+
+private:
+    CurlMultiLoop() : multi_(curl_multi_init()), thread_running_(false) {
+        if (multi_) {
+            curl_multi_setopt(multi_, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+        }
+    }
+
+    /**
+     * Loop thread: add submitted requests, drive the transfers and complete finished ones.
+     */
+    void Run() {
+        auto idle_since = std::chrono::steady_clock::now();
+        while (true) {
+            // Step 1: Attach newly submitted requests (or exit when idle for long enough)
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (auto& request : submitted_) {
+                    CURL* easy = request->handle.curl;
+                    curl_multi_add_handle(multi_, easy);
+                    running_[easy] = std::move(request);
+                }
+                submitted_.clear();
+                if (running_.empty()) {
+                    if (std::chrono::steady_clock::now() - idle_since >= std::chrono::seconds(kIdleTimeoutSeconds)) {
+                        thread_running_ = false;
+                        return;
+                    }
+                } else {
+                    idle_since = std::chrono::steady_clock::now();
+                }
+            }
+
+            // Step 2: Drive all transfers
+            int still_running = 0;
+            curl_multi_perform(multi_, &still_running);
+
+            // Step 3: Complete finished transfers
+            int messages_left = 0;
+            while (CURLMsg* message = curl_multi_info_read(multi_, &messages_left)) {
+                if (message->msg != CURLMSG_DONE) {
+                    continue;
+                }
+                CURL* easy = message->easy_handle;
+                CURLcode curl_result = message->data.result;
+                curl_multi_remove_handle(multi_, easy);
+                Complete(easy, curl_result);
+            }
+
+            // Step 4: Sleep until there is socket activity, a new request or a timeout
+            curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+        }
+    }
+
+    /**
+     * Deliver the result of a finished request and return its handle to the pool.
+     */
+    void Complete(CURL* easy, CURLcode curl_result) {
+        std::unique_ptr<AsyncCurlRequest> request;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = running_.find(easy);
+            if (it == running_.end()) {
+                return;
+            }
+            request = std::move(it->second);
+            running_.erase(it);
+        }
+
+        long http_status_code = 0;
+        curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &http_status_code);
+        try {
+            request->result.set_value(ParseHttpResponse(curl_result, http_status_code, request->response_string));
+        } catch (...) {
+            request->result.set_exception(std::current_exception());
+        }
+        request->pool->Release(request->handle);
+    }
+
+    CURLM* multi_;                                                        ///< Multi handle driving all transfers
+    std::mutex mutex_;                                                    ///< Protects the members below
+    std::vector<std::unique_ptr<AsyncCurlRequest>> submitted_;            ///< Requests not yet attached
+    std::unordered_map<CURL*, std::unique_ptr<AsyncCurlRequest>> running_; ///< Attached requests by easy handle
+    bool thread_running_;                                                 ///< Loop thread is running
+    std::thread thread_;                                                  ///< Loop thread
+};
+
+std::shared_future<json> HippoClient::HttpRequestAsync(const std::string& method,
+                                                       const std::string& url,
+                                                       const json& payload,
+                                                       const std::string& token,
+                                                       long timeoutSeconds) {
+    // Fall back to a blocking request if curl multi is unavailable
+    CurlMultiLoop& loop = CurlMultiLoop::Instance();
+    if (!loop.IsAvailable()) {
+        std::promise<json> result;
+        try {
+            result.set_value(HttpRequest(method, url, payload, token, timeoutSeconds));
+        } catch (...) {
+            result.set_exception(std::current_exception());
+        }
+        return result.get_future().share();
+    }
+
+    // 1. Take a pooled CURL handle and configure it like a blocking request
+    std::unique_ptr<AsyncCurlRequest> request(new AsyncCurlRequest());
+    request->pool = &CurlHandlePool::ForBaseUrl(base_url_);
+    request->handle = request->pool->Acquire();
+    if (!request->handle.curl) {
+        throw std::runtime_error("Failed to initialize curl handle");
+    }
+    ConfigureCurlRequest(request->handle, method, url, payload, token, timeoutSeconds, &request->response_string);
+
+    // 2. Hand it to the multi loop
+    std::shared_future<json> result = request->result.get_future().share();
+    loop.Submit(std::move(request));
+    return result;
+}
+
+HippoClient::AsyncResponse HippoClient::RequestWithTokenAsync(const std::string& method,
+                                                              const std::string& url,
+                                                              const json& payload,
+                                                              long timeoutSeconds) {
+    AsyncResponse response;
+    response.method_ = method;
+    response.url_ = url;
+    response.payload_ = payload;
+    response.timeout_seconds_ = timeoutSeconds;
+    try {
+        response.token_ = GetToken();
+        std::cout << "[HippoClient] Making async request to: " << url << std::endl;
+        response.first_attempt_ = HttpRequestAsync(method, url, payload, response.token_, timeoutSeconds);
+    } catch (const std::exception& error) {
+        // get() retries through the blocking path
+        std::cerr << "[HippoClient] Async request could not be started for URL=" << url
+                  << ": " << error.what() << std::endl;
+    }
+    return response;
+}
+
+bool HippoClient::AsyncResponse::IsReady() const {
+    return !first_attempt_.valid() ||
+           first_attempt_.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+}
+
+json HippoClient::AsyncResponse::Get() {
+    if (first_attempt_.valid()) {
+        try {
+            return first_attempt_.get();
+        } catch (const std::exception& error) {
+            std::string error_message = error.what();
+            std::cerr << "[HippoClient] Async request failed for URL=" << url_ << ": " << error_message << std::endl;
+            if (error_message.find(HTTP_STATUS_UNAUTHORIZED) != std::string::npos) {
+                RenewRejectedToken(token_);
+            }
+        }
+    }
+    // Retry through the blocking path (token renewal, backoff); together with the first
+    // attempt this makes the usual three attempts
+    return RequestWithToken(method_, url_, payload_, 2, timeout_seconds_);
+}
@@ -1,6 +1,10 @@
 #ifndef HIPPO_CLIENT_H
 #define HIPPO_CLIENT_H
 
+#include <condition_variable>
+#include <ctime>
+#include <future>
+#include <mutex>
 #include <string>
 #include <nlohmann/json.hpp>
 
@@ -11,6 +15,37 @@
  */
 class HippoClient {
 public:
+  /**
+   * Result of a request started with one of the *Async methods.
+   * The request runs on HippoClient's curl multi loop, multiplexed with other requests over
+   * a shared HTTP/2 connection. If it fails, Get() retries it through the blocking path
+   * (renewing the token on 401), so the outcome matches the blocking method's.
+   * Not thread-safe: consume each response from one thread.
+   */
+  class AsyncResponse {
+  public:
+    /**
+     * True once the first attempt has finished (Get() then only blocks for a retry).
+     */
+    bool IsReady() const;
+
+    /**
+     * Wait for the response JSON; throws like the blocking method if all attempts fail.
+     * Call once.
+     */
+    nlohmann::json Get();
+
+  private:
+    friend class HippoClient;
+
+    std::shared_future<nlohmann::json> first_attempt_;  ///< Multiplexed attempt (invalid if it could not start)
+    std::string method_;                                ///< Request parameters for the blocking retry
+    std::string url_;
+    nlohmann::json payload_;
+    std::string token_;                                 ///< Token the first attempt was sent with
+    long timeout_seconds_ = 30;
+  };
+
   /**
    * Initialize the HippoClient with base URL and credentials.
    * This method must be called once before using any other API methods.
@@ -34,33 +69,79 @@ public:
    */
   static nlohmann::json ConfirmIncrementalUploadFile(const nlohmann::json& payload);
 
+  /**
+   * Start an incremental upload confirmation without waiting for it.
+   * Many confirmations can be in flight at once on one connection and no extra threads.
+   * @param payload JSON payload, same structure as ConfirmIncrementalUploadFile
+   * @return Pending response (same JSON as ConfirmIncrementalUploadFile)
+   */
+  static AsyncResponse ConfirmIncrementalUploadFileAsync(const nlohmann::json& payload);
+
   /**
    * Get S3 credentials for accessing patient-specific folders.
+   * The first request per patient may be answered from the credential cache.
    * @param patientId Patient identifier used to generate S3 credentials
    * @return JSON response containing S3 access credentials
    */
   static nlohmann::json GetS3Credentials(const std::string& patientId);
 
+  /**
+   * Warm up for the first request: open a kept-alive connection to the API and obtain a
+   * token (login, or the cached JWT). Failures are only logged; the first real request
+   * runs the same steps again.
+   * @return true if a token is available
+   */
+  static bool Prewarm();
+
 private:
   /**
    * Perform login and obtain JWT token.
-   * Stores the JWT token and hospital ID in static members upon successful login.
    * Throws std::runtime_error if login fails or response is invalid.
+   * @param jwt_token Receives the JWT token
+   * @param hospital_id Receives the hospital ID of the account
    */
-  static void Login();
+  static void Login(std::string& jwt_token, std::string& hospital_id);
 
   /**
    * Get the current authentication token, performing login if necessary.
+   * A still valid token of a previous process is taken from the credential cache first.
+   * Once the token is within JWT_RENEWAL_MARGIN_SECONDS of its "exp" claim, one caller
+   * renews it while the others keep using the current token.
+   * Thread-safe; at most one login is in flight and concurrent callers wait for it.
    * @return Bearer token string (e.g., "Bearer <jwt_token>")
    */
   static std::string GetToken();
 
+  /**
+   * Replace a token the server rejected with 401.
+   * Only the first caller reporting a given token logs in again; callers whose token was
+   * already replaced return immediately and retry with the new one.
+   * Throws std::runtime_error if the login fails after retries.
+   * @param rejected_token Bearer token string the request was sent with
+   */
+  static void RenewRejectedToken(const std::string& rejected_token);
+
+  /**
+   * Run the login, or wait for the login already in flight and share its outcome.
+   * Installs the new token on success. token_mutex_ must be held through lock; it is
+   * released during the network call.
+   * @param lock Lock on token_mutex_
+   * @param maxLoginRetries Login attempts if this caller performs the login
+   * @param error Receives the error message of a failed login
+   * @return true if the login succeeded
+   */
+  static bool SingleFlightLogin(std::unique_lock<std::mutex>& lock, int maxLoginRetries, std::string& error);
+
   /**
    * Attempt login with automatic retry mechanism and exponential backoff.
-   * @param maxLoginRetries Maximum number of login retry attempts (default: 3)
+   * @param maxLoginRetries Maximum number of login retry attempts
+   * @param jwt_token Receives the JWT token
+   * @param hospital_id Receives the hospital ID of the account
+   * @param error Receives the error message of the last attempt
    * @return true if login succeeded, false if all retries failed
    */
-  static bool LoginWithRetries(int maxLoginRetries = 3);
+  static bool LoginWithRetries(int maxLoginRetries, std::string& jwt_token, std::string& hospital_id,
+                               std::string& error);
 
   /**
    * Make an HTTP request with automatic token management and retry logic.
@@ -78,6 +159,36 @@ private:
                                          int maxRetries = 3,
                                          long timeoutSeconds = 30);
 
+  /**
+   * Start a request with the current token on the curl multi loop.
+   * @param method HTTP method (GET, POST, PUT, DELETE)
+   * @param url Full request URL
+   * @param payload JSON payload (only used for POST/PUT requests)
+   * @param timeoutSeconds Total timeout in seconds (default: 30)
+   * @return Pending response; failures are retried by AsyncResponse::Get()
+   */
+  static AsyncResponse RequestWithTokenAsync(const std::string& method,
+                                             const std::string& url,
+                                             const nlohmann::json& payload,
+                                             long timeoutSeconds = 30);
+
+  /**
+   * Low-level asynchronous HTTP request on the curl multi loop.
+   * Same options and error handling as HttpRequest; the future holds the parsed
+   * response or the exception HttpRequest would have thrown.
+   * @param method HTTP method (GET, POST, PUT, DELETE)
+   * @param url Full request URL
+   * @param payload JSON payload (only used for POST/PUT requests)
+   * @param token Authorization token (optional, format: "Bearer <token>")
+   * @param timeoutSeconds Total timeout in seconds
+   * @return Future of the JSON response
+   */
+  static std::shared_future<nlohmann::json> HttpRequestAsync(const std::string& method,
+                                                             const std::string& url,
+                                                             const nlohmann::json& payload,
+                                                             const std::string& token,
+                                                             long timeoutSeconds);
+
   /**
    * Low-level HTTP request function using libcurl.
    * Performs the actual HTTP request and returns parsed JSON response.
@@ -101,6 +212,14 @@ private:
   static std::string password_;      ///< User password
   static std::string jwt_token_;     ///< Current JWT authentication token
   static std::string hospital_id_;   ///< Hospital identifier from login response
+  static std::time_t jwt_expiration_;  ///< "exp" claim of jwt_token_ (0 if unknown)
+  static std::mutex token_mutex_;    ///< Protects the token and login state
+  static std::condition_variable login_cv_;  ///< Signals the end of a login
+  static bool login_in_progress_;    ///< A login is in flight
+  static unsigned long long logins_finished_;  ///< Number of finished logins
+  static bool last_login_succeeded_; ///< Outcome of the last finished login
+  static std::string last_login_error_;  ///< Error message of the last failed login
+  static const std::time_t JWT_RENEWAL_MARGIN_SECONDS;  ///< Renew the token this long before it expires
   static const std::string HTTP_STATUS_UNAUTHORIZED; ///< HTTP 401 status code string
 };
 
@@ -3,9 +3,15 @@
 #include <aws/core/client/ClientConfiguration.h>
 #include <aws/s3/S3Client.h>
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 
 using json = nlohmann::json;
 
+// Interval of TCP keep-alive probes on pooled connections (milliseconds)
+static const unsigned long kTcpKeepAliveIntervalMs = 30000;
+
 RefreshingS3Client::RefreshingS3Client(std::shared_ptr<S3ClientManager> manager, const std::string& patient_id)
     : manager_(manager), patient_id_(patient_id) {}
 
@@ -24,7 +30,24 @@ S3ClientManager::S3ClientManager(const std::string& region, TokenFetcher fetcher
     : region_(region),
       token_fetcher_(fetcher),
       max_pool_connections_(max_pool_connections),
-      refresh_margin_(refresh_margin) {}
+      refresh_margin_(refresh_margin),
+      credential_fetched_at_(0),
+      refresh_fraction_(kDefaultRefreshFraction),
+      refresh_retry_at_(0),
+      last_used_at_(std::time(nullptr)),
+      refresher_parked_(false),
+      stop_refresher_(false) {}
+
+S3ClientManager::~S3ClientManager() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_refresher_ = true;
+    }
+    refresher_cv_.notify_all();
+    if (refresher_.joinable()) {
+        refresher_.join();
+    }
+}
 
 bool S3ClientManager::need_refresh(const std::string& patient_id) {
     const auto current_time = std::time(nullptr);
@@ -54,10 +77,17 @@ bool S3ClientManager::need_refresh(const std::string& patient_id) {
 
 std::shared_ptr<Aws::S3::S3Client> S3ClientManager::get_client(const std::string& patient_id) {
     // Thread-safe access using mutex lock
-    std::lock_guard<std::mutex> lock(mutex_);
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    // Record the use; a refresher parked for inactivity resumes its schedule
+    last_used_at_ = std::time(nullptr);
+    if (refresher_parked_) {
+        refresher_parked_ = false;
+        refresher_cv_.notify_all();
+    }
 
     if (need_refresh(patient_id)) {
-        return refresh_client(patient_id);
+        return refresh_client(lock, patient_id);
     }
 
     return current_client_;
@@ -75,9 +105,58 @@ std::shared_ptr<RefreshingS3Client> S3ClientManager::get_refreshing_client(const
     }
 }
 
-std::shared_ptr<Aws::S3::S3Client> S3ClientManager::refresh_client(const std::string& patient_id) {
+std::shared_ptr<Aws::S3::S3Client> S3ClientManager::refresh_client(std::unique_lock<std::mutex>& lock,
+                                                                   const std::string& patient_id) {
+    // Step 1: Join a fetch already in flight for this patient instead of issuing another
+    auto pending = inflight_fetches_.find(patient_id);
+    while (pending != inflight_fetches_.end()) {
+        std::shared_future<void> result = pending->second;
+        lock.unlock();
+        result.wait();
+        lock.lock();
+        result.get();  // Rethrows the failure of the fetch we waited for
+        if (current_client_ && current_patient_id_ == patient_id) {
+            return current_client_;
+        }
+        // Another patient's credentials were installed meanwhile; fetch our own
+        pending = inflight_fetches_.find(patient_id);
+    }
+
+    // Step 2: Publish our fetch so that concurrent callers wait for it
     AWS_LOGSTREAM_INFO("S3ClientManager", "Refreshing client for patient_id: " << patient_id);
+    std::promise<void> done;
+    inflight_fetches_[patient_id] = done.get_future().share();
 
+    // Step 3: Fetch without the lock; callers with valid credentials are not blocked
+    lock.unlock();
+    S3Credential credential;
+    std::exception_ptr error;
+    try {
+        credential = fetch_credential(patient_id);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    lock.lock();
+    inflight_fetches_.erase(patient_id);
+
+    // Step 4: Install the credentials and hand the outcome to the waiting callers
+    std::shared_ptr<Aws::S3::S3Client> client;
+    if (!error) {
+        try {
+            client = apply_credential_locked(patient_id, credential);
+        } catch (...) {
+            error = std::current_exception();
+        }
+    }
+    if (error) {
+        done.set_exception(error);
+        std::rethrow_exception(error);
+    }
+    done.set_value();
+    return client;
+}
+
+S3Credential S3ClientManager::fetch_credential(const std::string& patient_id) {
     // Fetch credentials from token fetcher
     json credential_json;
     try {
@@ -100,20 +179,17 @@ std::shared_ptr<Aws::S3::S3Client> S3ClientManager::refresh_client(const std::st
                            << patient_id << ", error: " << e.what());
         throw; // Re-throw to let caller handle the error
     }
+    return credential;
+}
 
-    // Configure S3 client with timeout settings and disable IMDS
-    // Using ClientConfiguration instead of S3ClientConfiguration to avoid linker symbol conflicts
-    AWS_LOGSTREAM_INFO("S3ClientManager", "Creating S3 client configuration...");
-    Aws::Client::ClientConfiguration client_config;
-    client_config.region = region_;
-    // Set timeouts: 30 seconds for request timeout, 10 seconds for connect timeout
-    client_config.requestTimeoutMs = 30000;
-    client_config.connectTimeoutMs = 10000;
-    // Disable EC2 Instance Metadata Service (IMDS) to avoid timeout errors
-    client_config.disableIMDS = true;
+std::shared_ptr<Aws::S3::S3Client> S3ClientManager::apply_credential_locked(const std::string& patient_id,
+                                                                            const S3Credential& credential) {
+    // Reschedule the background refresher for the new credentials
+    credential_fetched_at_ = std::time(nullptr);
+    refresh_retry_at_ = 0;
+    refresher_cv_.notify_all();
 
     // Create AWS credentials with optional session token
-    AWS_LOGSTREAM_INFO("S3ClientManager", "Creating AWS credentials...");
     Aws::Auth::AWSCredentials aws_credentials;
     if (!credential.sessionToken.empty()) {
         // Use temporary credentials (from AWS STS - Security Token Service)
@@ -130,9 +206,33 @@ std::shared_ptr<Aws::S3::S3Client> S3ClientManager::refresh_client(const std::st
             credential.secretAccessKey);
     }
 
-    // Create credentials provider wrapper
+    if (current_client_ && credentials_provider_) {
+        // Rotate the keys in place; the client keeps its warm connections
+        credentials_provider_->set_credentials(aws_credentials);
+        current_patient_id_ = patient_id;
+        current_credential_ = credential;
+        AWS_LOGSTREAM_INFO("S3ClientManager", "Rotated credentials in place for patient_id: " << patient_id);
+        return current_client_;
+    }
+
+    // Configure S3 client with timeout settings and disable IMDS
+    // Using ClientConfiguration instead of S3ClientConfiguration to avoid linker symbol conflicts
+    AWS_LOGSTREAM_INFO("S3ClientManager", "Creating S3 client configuration...");
+    Aws::Client::ClientConfiguration client_config;
+    client_config.region = region_;
+    // Set timeouts: 30 seconds for request timeout, 10 seconds for connect timeout
+    client_config.requestTimeoutMs = 30000;
+    client_config.connectTimeoutMs = 10000;
+    // Disable EC2 Instance Metadata Service (IMDS) to avoid timeout errors
+    client_config.disableIMDS = true;
+    // Pool size and TCP keep-alive, so pooled connections survive idle gaps between files
+    client_config.maxConnections = static_cast<unsigned>(max_pool_connections_);
+    client_config.enableTcpKeepAlive = true;
+    client_config.tcpKeepAliveIntervalMs = kTcpKeepAliveIntervalMs;
+
+    // Create the swappable credentials provider the client reads on every request
     AWS_LOGSTREAM_INFO("S3ClientManager", "Creating credentials provider...");
-    auto credentials_provider = Aws::MakeShared<Aws::Auth::SimpleAWSCredentialsProvider>(
+    auto credentials_provider = Aws::MakeShared<SwappableCredentialsProvider>(
         "S3ClientManager", aws_credentials);
 
     // Create S3 client with shared_ptr ownership
@@ -145,17 +245,164 @@ std::shared_ptr<Aws::S3::S3Client> S3ClientManager::refresh_client(const std::st
         true);
 
     // Update cached values
+    credentials_provider_ = credentials_provider;
     current_patient_id_ = patient_id;
     current_client_ = s3_client;
     current_credential_ = credential;
 
+    // Renew the credentials in the background from now on
+    if (!refresher_.joinable()) {
+        refresher_ = std::thread(&S3ClientManager::refresher_loop, this);
+    }
+
     AWS_LOGSTREAM_INFO("S3ClientManager", "Successfully refreshed client for patient_id: " << patient_id);
 
     return s3_client;
 }
 
 std::shared_ptr<Aws::S3::S3Client> S3ClientManager::force_refresh(const std::string& patient_id) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    return refresh_client(lock, patient_id);
+}
+
+void S3ClientManager::set_refresh_fraction(double fraction) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh_fraction_ = (fraction > 0.0 && fraction < 1.0) ? fraction : 0.0;
+    refresher_cv_.notify_all();
+}
+
+std::time_t S3ClientManager::next_refresh_time_locked() const {
+    const std::time_t expiration = current_credential_.expiration;
+    // Never later than the point where get_client() would refresh inline
+    const std::time_t latest = expiration > refresh_margin_ ? expiration - refresh_margin_ : 0;
+    if (expiration <= credential_fetched_at_) {
+        return latest;
+    }
+    const double lifetime = static_cast<double>(expiration - credential_fetched_at_);
+    const std::time_t due = credential_fetched_at_ + static_cast<std::time_t>(lifetime * refresh_fraction_);
+    return (std::min)(due, latest);
+}
+
+void S3ClientManager::refresher_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stop_refresher_) {
+        // Step 1: Sleep until the credentials are due (woken early on any schedule change)
+        if (refresh_fraction_ <= 0.0 || !current_client_) {
+            refresher_cv_.wait(lock);
+            continue;
+        }
+        const std::time_t due = refresh_retry_at_ != 0 ? refresh_retry_at_ : next_refresh_time_locked();
+        const auto wake_time = std::chrono::system_clock::from_time_t(due);
+        if (std::chrono::system_clock::now() < wake_time) {
+            refresher_cv_.wait_until(lock, wake_time);
+            continue;
+        }
+
+        // Step 1.1: Park while the manager is unused for longer than one credential lifetime
+        // (no fetches for idle patients); get_client() wakes it, refreshing inline if needed
+        const std::time_t lifetime = current_credential_.expiration - credential_fetched_at_;
+        if (lifetime > 0 && std::time(nullptr) - last_used_at_ > lifetime) {
+            AWS_LOGSTREAM_INFO("S3ClientManager", "Pausing background refresh for idle patient_id: " << current_patient_id_);
+            refresher_parked_ = true;
+            refresh_retry_at_ = 0;
+            refresher_cv_.wait(lock, [this] { return stop_refresher_ || !refresher_parked_; });
+            continue;
+        }
+
+        // Step 2: Refresh through the single-flight path (the lock is released while fetching,
+        // so get_client() keeps serving the current client)
+        const std::string patient_id = current_patient_id_;
+        AWS_LOGSTREAM_INFO("S3ClientManager", "Refreshing credentials in background for patient_id: " << patient_id);
+        try {
+            refresh_client(lock, patient_id);
+        } catch (const std::exception& e) {
+            AWS_LOGSTREAM_WARN("S3ClientManager", "Background credential refresh failed, retrying in "
+                               << kRefreshRetrySeconds << "s: " << e.what());
+            refresh_retry_at_ = std::time(nullptr) + kRefreshRetrySeconds;
+        } catch (...) {
+            AWS_LOGSTREAM_WARN("S3ClientManager", "Background credential refresh failed, retrying in "
+                               << kRefreshRetrySeconds << "s");
+            refresh_retry_at_ = std::time(nullptr) + kRefreshRetrySeconds;
+        }
+    }
+}
+
+// ---------------- S3ClientRegistry Implementation ----------------
+
+S3ClientRegistry& S3ClientRegistry::instance() {
+    // Intentionally leaked: destroying S3 clients while the DLL is being unloaded can hang
+    static S3ClientRegistry* registry = new S3ClientRegistry();
+    return *registry;
+}
+
+std::shared_ptr<S3ClientManager> S3ClientRegistry::get_manager(const std::string& region, const std::string& patient_id,
+                                                               TokenFetcher fetcher) {
+    const std::string key = region + "|" + patient_id;
+    std::list<Entry> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        // Move to the front (most recently used)
+        entries_.splice(entries_.begin(), entries_, it->second);
+        return it->second->second;
+    }
+
+    // Creating a manager is cheap; credentials are fetched on its first get_client()
+    AWS_LOGSTREAM_INFO("S3ClientRegistry", "Creating S3ClientManager for region: " << region << ", patient_id: " << patient_id);
+    auto manager = std::make_shared<S3ClientManager>(region, fetcher);
+    manager->set_refresh_fraction(refresh_fraction_);
+    entries_.emplace_front(key, manager);
+    index_[key] = entries_.begin();
+    evict_locked(dropped);
+    release_in_background(dropped);
+    return manager;
+}
+
+void S3ClientRegistry::set_capacity(size_t capacity) {
+    std::list<Entry> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    capacity_ = (std::max)(capacity, static_cast<size_t>(1));
+    evict_locked(dropped);
+    release_in_background(dropped);
+}
+
+void S3ClientRegistry::set_refresh_fraction(double fraction) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    refresh_fraction_ = fraction;
+    for (auto& entry : entries_) {
+        entry.second->set_refresh_fraction(fraction);
+    }
+}
+
+void S3ClientRegistry::clear() {
+    std::list<Entry> dropped;
+    std::lock_guard<std::mutex> lock(mutex_);
+    index_.clear();
+    dropped.swap(entries_);
+    release_in_background(dropped);
+}
+
+size_t S3ClientRegistry::size() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return refresh_client(patient_id);
+    return entries_.size();
 }
 
+void S3ClientRegistry::evict_locked(std::list<Entry>& dropped) {
+    while (entries_.size() > capacity_) {
+        AWS_LOGSTREAM_INFO("S3ClientRegistry", "Evicting S3ClientManager for " << entries_.back().first);
+        index_.erase(entries_.back().first);
+        dropped.splice(dropped.begin(), entries_, std::prev(entries_.end()));
+    }
+}
+
+void S3ClientRegistry::release_in_background(std::list<Entry>& dropped) {
+    if (dropped.empty()) {
+        return;
+    }
+    // The caller is often the UI thread (SetCredential); let the detached thread do the joins
+    std::thread([](std::list<Entry> managers) {
+        managers.clear();
+    }, std::move(dropped)).detach();
+    dropped.clear();
+}
@@ -1,14 +1,20 @@
 #pragma once
 
 #include <aws/s3/S3Client.h>
+#include <aws/core/auth/AWSCredentialsProvider.h>
 #include <nlohmann/json.hpp>
 #include <memory>
 #include <mutex>
+#include <condition_variable>
+#include <future>
+#include <thread>
 #include <ctime>
 #include <string>
 #include <functional>
 #include <stdexcept>
 #include <limits>
+#include <list>
+#include <unordered_map>
 
 /**
  * Function type for fetching AWS S3 credentials token.
@@ -65,6 +71,44 @@ struct S3Credential {
 };
 
 
+/**
+ * Credentials provider whose credentials can be replaced while clients are using it.
+ * The S3 client asks its provider for credentials when signing each request, so
+ * rotating the keys here takes effect on the next request without rebuilding the
+ * client or dropping its pooled keep-alive connections.
+ * Thread-safe: readers and the rotating thread synchronize on a mutex.
+ */
+class SwappableCredentialsProvider : public Aws::Auth::AWSCredentialsProvider {
+public:
+    explicit SwappableCredentialsProvider(const Aws::Auth::AWSCredentials& credentials)
+        : credentials_(credentials) {}
+
+    /**
+     * Returns a copy of the current credentials (called by the SDK for every request).
+     */
+    Aws::Auth::AWSCredentials GetAWSCredentials() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return credentials_;
+    }
+
+    /**
+     * Replaces the credentials used for subsequent requests.
+     */
+    void set_credentials(const Aws::Auth::AWSCredentials& credentials) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        credentials_ = credentials;
+    }
+
+private:
+    Aws::Auth::AWSCredentials credentials_;  ///< Credentials handed out to the client
+    std::mutex mutex_;                       ///< Protects credentials_
+};
+
+/// Default point of the credential lifetime at which the background refresher renews them
+static const double kDefaultRefreshFraction = 0.75;
+/// Delay in seconds before the background refresher retries a failed credential fetch
+static const std::time_t kRefreshRetrySeconds = 30;
+
 // Forward declaration
 class S3ClientManager;
 
@@ -121,13 +165,18 @@ public:
      * Constructs an S3ClientManager with the specified configuration.
      * @param region AWS region for S3 operations
      * @param fetcher Function to fetch AWS credentials token
-     * @param max_pool_connections Maximum number of pool connections (currently unused, reserved for future use)
+     * @param max_pool_connections Maximum number of pooled connections of the S3 client
      * @param refresh_margin Time margin in seconds before expiration to trigger refresh
      */
     S3ClientManager(const std::string& region, TokenFetcher fetcher,
                     size_t max_pool_connections = 25,
                     std::time_t refresh_margin = 300);
 
+    /**
+     * Stops the background refresher (waits for a credential fetch in progress).
+     */
+    ~S3ClientManager();
+
     /**
      * Gets an S3 client for the specified patient ID.
      * Automatically refreshes credentials if needed (patient ID changed, client missing, or credentials expiring soon).
@@ -146,10 +195,22 @@ public:
 
     /**
      * Force refresh the S3 client for a patient id regardless of current cached state.
+     * Joins a fetch already in flight for the patient instead of starting another.
      * Thread-safe.
      */
     std::shared_ptr<Aws::S3::S3Client> force_refresh(const std::string& patient_id);
 
+    /**
+     * Sets the point of the credential lifetime at which the background refresher renews them.
+     * Once a client exists, a background thread fetches new credentials when this fraction of
+     * their lifetime (fetch time to expiration) has passed, and at the latest refresh_margin
+     * before expiration, so get_client() does not have to fetch them on an upload's critical path.
+     * The inline refresh in get_client() stays in place as a fallback.
+     * @param fraction Fraction of the lifetime in (0, 1); 0 disables the background refresh
+     * Thread-safe.
+     */
+    void set_refresh_fraction(double fraction);
+
 private:
     /**
      * Checks if the S3 client needs to be refreshed.
@@ -159,25 +220,157 @@ private:
     bool need_refresh(const std::string& patient_id);
 
     /**
-     * Refreshes the S3 client by fetching new credentials and creating a new client.
-     * This method should only be called from get_client() which holds the mutex lock.
+     * Refreshes the credentials by fetching new ones from the token fetcher.
+     * The first call creates the S3 client; later calls only swap the keys in its
+     * credentials provider, so the client and its connection pool are kept.
+     * Single-flight per patient ID: if a fetch for the patient is already in flight, the
+     * caller waits for its result (and shares its failure) instead of issuing another.
+     * The lock is released during the network call and held again on return or throw.
+     * @param lock Lock on mutex_ held by the caller
+     * @param patient_id Patient ID to fetch credentials for
+     * @return Shared pointer to the S3 client
+     */
+    std::shared_ptr<Aws::S3::S3Client> refresh_client(std::unique_lock<std::mutex>& lock,
+                                                      const std::string& patient_id);
+
+    /**
+     * Fetches and parses credentials from the token fetcher.
+     * Does not touch cached state, so it is called without the mutex lock.
      * @param patient_id Patient ID to fetch credentials for
-     * @return Shared pointer to the newly created S3 client
+     * @return Parsed credentials
      */
-    std::shared_ptr<Aws::S3::S3Client> refresh_client(const std::string& patient_id);
+    S3Credential fetch_credential(const std::string& patient_id);
+
+    /**
+     * Installs fetched credentials: creates the S3 client on first use, otherwise swaps
+     * the keys in its credentials provider. Starts the background refresher with the client.
+     * Assumes mutex_ is held.
+     * @param patient_id Patient ID the credentials were fetched for
+     * @param credential Credentials to install
+     * @return Shared pointer to the S3 client
+     */
+    std::shared_ptr<Aws::S3::S3Client> apply_credential_locked(const std::string& patient_id,
+                                                               const S3Credential& credential);
+
+    /**
+     * Time at which the background refresher renews the current credentials.
+     * Assumes mutex_ is held.
+     */
+    std::time_t next_refresh_time_locked() const;
+
+    /**
+     * Body of the background refresher thread.
+     * Sleeps until the next refresh time, fetches credentials without holding the mutex
+     * and installs them, until the manager is destroyed. Pauses while get_client() has not
+     * been called for longer than one credential lifetime.
+     */
+    void refresher_loop();
 
     std::string region_;                  ///< AWS region for S3 operations
     TokenFetcher token_fetcher_;          ///< Function to fetch AWS credentials token
-    size_t max_pool_connections_;        ///< Maximum number of pool connections (reserved for future use)
+    size_t max_pool_connections_;        ///< Maximum number of pooled connections (ClientConfiguration::maxConnections)
     std::time_t refresh_margin_;          ///< Time margin in seconds before expiration to trigger refresh
 
     std::string current_patient_id_;                      ///< Currently cached patient ID
     std::shared_ptr<Aws::S3::S3Client> current_client_;  ///< Currently cached S3 client
     S3Credential current_credential_;                     ///< Currently cached credentials
+    std::shared_ptr<SwappableCredentialsProvider> credentials_provider_;  ///< Provider read by current_client_
+    std::time_t credential_fetched_at_;                   ///< Time the current credentials were fetched
+    std::unordered_map<std::string, std::shared_future<void>> inflight_fetches_;  ///< Patient ID -> fetch in flight
+
+    double refresh_fraction_;             ///< Lifetime fraction for background refresh (0 = disabled)
+    std::time_t refresh_retry_at_;        ///< Retry time after a failed background fetch (0 = none)
+    std::time_t last_used_at_;            ///< Time of the last get_client() call
+    bool refresher_parked_;               ///< Refresher paused because the manager is idle
+    bool stop_refresher_;                 ///< Set by the destructor to end refresher_loop()
+    std::thread refresher_;               ///< Background refresher thread (started with the client)
+    std::condition_variable refresher_cv_;  ///< Wakes the refresher when its schedule changes
 
     std::mutex mutex_;  ///< Mutex for thread-safe access
 };
 
+/**
+ * Process-wide registry of S3ClientManager instances keyed by (region, patient ID).
+ * Uploads for the same patient and region share one manager, and with it the cached
+ * credentials (reused until refresh_margin before expiry) and the S3 client's connection
+ * pool, instead of fetching credentials and opening new connections for every file.
+ * The registry is bounded; the least recently used manager is dropped once the capacity
+ * is exceeded. Callers keep the returned manager alive for as long as they use it
+ * (RefreshingS3Client only holds a weak reference), so eviction never breaks a running upload.
+ * Thread-safe.
+ */
+class S3ClientRegistry {
+public:
+    /// Default number of (region, patient ID) managers kept
+    static const size_t kDefaultCapacity = 16;
+
+    /**
+     * Gets the process-wide registry.
+     * The instance is never destroyed, so no S3 client is torn down during DLL unload.
+     */
+    static S3ClientRegistry& instance();
+
+    /**
+     * Gets the manager for a region and patient ID, creating it on first use.
+     * @param region AWS region for S3 operations
+     * @param patient_id Patient ID the credentials are issued for
+     * @param fetcher Function to fetch AWS credentials token (used when the manager is created)
+     * @return Shared pointer to the manager; keep it while using clients obtained from it
+     */
+    std::shared_ptr<S3ClientManager> get_manager(const std::string& region, const std::string& patient_id,
+                                                 TokenFetcher fetcher);
+
+    /**
+     * Sets the maximum number of managers kept (at least 1); evicts immediately if needed.
+     */
+    void set_capacity(size_t capacity);
+
+    /**
+     * Sets the credential lifetime fraction of background refresh for current and future managers.
+     * @param fraction Fraction of the lifetime in (0, 1); 0 disables the background refresh
+     */
+    void set_refresh_fraction(double fraction);
+
+    /**
+     * Drops all managers (e.g. after the HippoClient account changed).
+     * Managers still held by running uploads stay alive until those finish;
+     * the others are destroyed in the background, so this never waits for a refresher.
+     */
+    void clear();
+
+    /**
+     * Number of managers currently kept.
+     */
+    size_t size() const;
+
+private:
+    S3ClientRegistry() : capacity_(kDefaultCapacity), refresh_fraction_(kDefaultRefreshFraction) {}
+    S3ClientRegistry(const S3ClientRegistry&) = delete;
+    S3ClientRegistry& operator=(const S3ClientRegistry&) = delete;
+
+    typedef std::pair<std::string, std::shared_ptr<S3ClientManager>> Entry;
+
+    /**
+     * Moves least recently used managers to dropped until the capacity is met.
+     * The caller hands dropped to release_in_background().
+     * Assumes mutex_ is held.
+     */
+    void evict_locked(std::list<Entry>& dropped);
+
+    /**
+     * Destroys dropped managers on a detached thread and empties dropped.
+     * Destroying a manager waits for its background refresher, which can take as
+     * long as a credential request with retries.
+     */
+    static void release_in_background(std::list<Entry>& dropped);
+
+    std::list<Entry> entries_;                                          ///< Managers, most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_; ///< "region|patientId" -> entry
+    size_t capacity_;                                                   ///< Maximum number of managers
+    double refresh_fraction_;                                           ///< Applied to every manager
+    mutable std::mutex mutex_;                                          ///< Protects entries_ and index_
+};
+
 // ---- Template implementation ----
 // Retry limit for expired-credential retries used by with_auto_refresh()
 static const int kMaxExpiredRetries = 3;
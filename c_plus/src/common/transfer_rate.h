@@ -0,0 +1,72 @@
+#ifndef TRANSFER_RATE_H
+#define TRANSFER_RATE_H
+
+#include <chrono>
+
+// Throughput is sampled at most this often (shorter windows are too noisy to report)
+static const long long TRANSFER_RATE_SAMPLE_MS = 1000;
+// Weight of the newest sample in the moving average
+static const double TRANSFER_RATE_SMOOTHING = 0.3;
+// A transfer without any bytes sent for this long is reported with a rate of 0
+static const long long TRANSFER_STALL_MS = 5000;
+
+// Throughput of a single transfer, fed with the cumulative bytes sent
+// instantBytesPerSecond covers the last sample window; averageBytesPerSecond is an
+// exponential moving average over the samples, which keeps the ETA steady while
+// the instantaneous rate jitters. Not thread-safe: owned by the transferring thread.
+class TransferRateMeter {
+public:
+    TransferRateMeter() : windowBytes_(0), lastBytes_(0), instant_(0), average_(0), hasAverage_(false) {}
+
+    // Start (or restart after a retry) counting from bytesSent
+    // The moving average is kept, so a retry starts with the previous estimate
+    void start(long long bytesSent, std::chrono::steady_clock::time_point now) {
+        windowStart_ = now;
+        windowBytes_ = bytesSent;
+        lastBytes_ = bytesSent;
+        instant_ = 0;
+    }
+
+    // Record the cumulative bytes sent
+    // Returns true when a sample window closed and the rates were updated
+    bool update(long long bytesSent, std::chrono::steady_clock::time_point now) {
+        lastBytes_ = bytesSent;
+        long long elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - windowStart_).count();
+        if (elapsedMs < TRANSFER_RATE_SAMPLE_MS) {
+            return false;
+        }
+
+        instant_ = (bytesSent - windowBytes_) * 1000 / elapsedMs;
+        if (hasAverage_) {
+            average_ = static_cast<long long>(TRANSFER_RATE_SMOOTHING * instant_ + (1.0 - TRANSFER_RATE_SMOOTHING) * average_);
+        } else {
+            average_ = instant_;
+            hasAverage_ = true;
+        }
+        windowStart_ = now;
+        windowBytes_ = bytesSent;
+        return true;
+    }
+
+    long long bytesSent() const {
+        return lastBytes_;
+    }
+
+    long long instantBytesPerSecond() const {
+        return instant_;
+    }
+
+    long long averageBytesPerSecond() const {
+        return average_;
+    }
+
+private:
+    std::chrono::steady_clock::time_point windowStart_;   // Start of the current sample window
+    long long windowBytes_;                               // Bytes sent when the window started
+    long long lastBytes_;                                 // Latest cumulative bytes sent
+    long long instant_;                                   // Rate over the last closed window
+    long long average_;                                   // Moving average of the window rates
+    bool hasAverage_;                                     // At least one window closed
+};
+
+#endif // TRANSFER_RATE_H
@@ -0,0 +1,160 @@
+#ifndef UPLOAD_ADMISSION_H
+#define UPLOAD_ADMISSION_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+
+// What UploadFileAsync does when the upload budget is exhausted
+enum AdmissionPolicy {
+    // Fail the call immediately ("Upload limit exceeded")
+    ADMISSION_REJECT = 0,
+    // Block the calling thread until budget frees up or the timeout elapses
+    ADMISSION_BLOCK = 1,
+    // Accept the upload but park it until budget frees up (UPLOAD_QUEUED_DEFERRED)
+    ADMISSION_DEFER = 2
+};
+
+// Default watermarks - bytes and task counts of uploads queued or transferring
+static const long long DEFAULT_ADMISSION_HIGH_WATERMARK_BYTES = 2048LL * 1024 * 1024;
+static const long long DEFAULT_ADMISSION_LOW_WATERMARK_BYTES = 1536LL * 1024 * 1024;
+static const size_t DEFAULT_ADMISSION_HIGH_WATERMARK_TASKS = 1000;
+static const size_t DEFAULT_ADMISSION_LOW_WATERMARK_TASKS = 800;
+static const long DEFAULT_ADMISSION_BLOCK_TIMEOUT_MS = 30000;
+
+// Admission control configuration
+struct UploadAdmissionConfig {
+    // Stop admitting when queued bytes would exceed this
+    long long highWatermarkBytes;
+    // Resume admitting once queued bytes drop to this
+    long long lowWatermarkBytes;
+    // Stop admitting when queued tasks would exceed this
+    size_t highWatermarkTasks;
+    // Resume admitting once queued tasks drop to this
+    size_t lowWatermarkTasks;
+    // Behaviour when over budget
+    AdmissionPolicy policy;
+    // Maximum wait for ADMISSION_BLOCK
+    long blockTimeoutMs;
+
+    UploadAdmissionConfig()
+        : highWatermarkBytes(DEFAULT_ADMISSION_HIGH_WATERMARK_BYTES),
+          lowWatermarkBytes(DEFAULT_ADMISSION_LOW_WATERMARK_BYTES),
+          highWatermarkTasks(DEFAULT_ADMISSION_HIGH_WATERMARK_TASKS),
+          lowWatermarkTasks(DEFAULT_ADMISSION_LOW_WATERMARK_TASKS),
+          policy(ADMISSION_REJECT),
+          blockTimeoutMs(DEFAULT_ADMISSION_BLOCK_TIMEOUT_MS) {}
+};
+
+// Byte and task budget for uploads that are queued or transferring
+// Admission stops when a new task would push the totals past the high watermarks and
+// only resumes once they have drained to the low watermarks (hysteresis), so a busy
+// queue does not flap between accepting and refusing on every completed file.
+// A single file larger than the byte budget is still admitted when nothing else is queued.
+class UploadAdmissionController {
+public:
+    UploadAdmissionController() : queuedBytes_(0), queuedTasks_(0), saturated_(false) {}
+
+    // Replace the configuration (watermarks are re-evaluated on the next admission)
+    void configure(const UploadAdmissionConfig& config) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            config_ = config;
+            updateSaturationLocked();
+        }
+        budgetCondition_.notify_all();
+    }
+
+    UploadAdmissionConfig getConfig() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_;
+    }
+
+    // Reserve budget for a task if it fits; never blocks
+    bool tryAdmit(long long bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return tryAdmitLocked(bytes);
+    }
+
+    // Reserve budget for a task, waiting up to timeoutMs for it to fit
+    bool admitWithTimeout(long long bytes, long timeoutMs) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        return budgetCondition_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [this, bytes] {
+            return tryAdmitLocked(bytes);
+        });
+    }
+
+    // Reserve budget unconditionally (continuation of an already admitted folder)
+    void forceAdmit(long long bytes) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queuedBytes_ += bytes;
+        queuedTasks_++;
+    }
+
+    // Return the budget of a task that left the transfer stage
+    void release(long long bytes) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queuedBytes_ = (queuedBytes_ > bytes) ? queuedBytes_ - bytes : 0;
+            if (queuedTasks_ > 0) queuedTasks_--;
+            updateSaturationLocked();
+        }
+        budgetCondition_.notify_all();
+    }
+
+    AdmissionPolicy getPolicy() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_.policy;
+    }
+
+    long getBlockTimeoutMs() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return config_.blockTimeoutMs;
+    }
+
+    long long getQueuedBytes() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queuedBytes_;
+    }
+
+    size_t getQueuedTasks() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return queuedTasks_;
+    }
+
+private:
+    bool tryAdmitLocked(long long bytes) {
+        if (saturated_ && queuedTasks_ > 0) {
+            return false;
+        }
+
+        bool fitsBytes = queuedTasks_ == 0 || queuedBytes_ + bytes <= config_.highWatermarkBytes;
+        bool fitsTasks = queuedTasks_ + 1 <= config_.highWatermarkTasks;
+        if (!fitsBytes || !fitsTasks) {
+            saturated_ = true;
+            return false;
+        }
+
+        saturated_ = false;
+        queuedBytes_ += bytes;
+        queuedTasks_++;
+        return true;
+    }
+
+    // Leave the saturated state once both totals are at or below the low watermarks
+    void updateSaturationLocked() {
+        if (queuedBytes_ <= config_.lowWatermarkBytes && queuedTasks_ <= config_.lowWatermarkTasks) {
+            saturated_ = false;
+        }
+    }
+
+    mutable std::mutex mutex_;                    // Protects all fields below
+    std::condition_variable budgetCondition_;     // Signalled when budget is returned or config changes
+    UploadAdmissionConfig config_;                // Current watermarks and policy
+    long long queuedBytes_;                       // Bytes of admitted tasks not yet finished transferring
+    size_t queuedTasks_;                          // Number of admitted tasks not yet finished transferring
+    bool saturated_;                              // True between hitting a high watermark and draining to the low one
+};
+
+#endif // UPLOAD_ADMISSION_H
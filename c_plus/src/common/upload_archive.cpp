@@ -0,0 +1,182 @@
+#include "S3Common.h"
+#include "upload_archive.h"
+
+// ---------------- StringInterner Implementation ----------------
+
+StringInterner::StringInterner() {
+    // Reference 0 is reserved for the empty string
+    static const std::string emptyString;
+    Entry emptyEntry = { &emptyString, 0 };
+    entries_.push_back(emptyEntry);
+}
+
+StringInterner::Ref StringInterner::acquire(const std::string& value) {
+    if (value.empty()) {
+        return EMPTY_REF;
+    }
+
+    auto it = lookup_.find(value);
+    if (it != lookup_.end()) {
+        entries_[it->second].refCount++;
+        return it->second;
+    }
+
+    Ref ref;
+    if (!freeRefs_.empty()) {
+        ref = freeRefs_.back();
+        freeRefs_.pop_back();
+    } else {
+        ref = static_cast<Ref>(entries_.size());
+        entries_.push_back(Entry());
+    }
+
+    auto inserted = lookup_.emplace(value, ref).first;
+    entries_[ref].value = &inserted->first;
+    entries_[ref].refCount = 1;
+    return ref;
+}
+
+void StringInterner::release(Ref ref) {
+    if (ref == EMPTY_REF || ref >= entries_.size() || entries_[ref].refCount == 0) {
+        return;
+    }
+
+    Entry& entry = entries_[ref];
+    if (--entry.refCount == 0) {
+        lookup_.erase(*entry.value);
+        entry.value = nullptr;
+        freeRefs_.push_back(ref);
+    }
+}
+
+const std::string& StringInterner::get(Ref ref) const {
+    if (ref >= entries_.size() || !entries_[ref].value) {
+        return *entries_[EMPTY_REF].value;
+    }
+    return *entries_[ref].value;
+}
+
+// ---------------- UploadArchive Implementation ----------------
+
+ArchivedUploadRecord::ArchivedUploadRecord()
+    : uploadTimestamp(0), totalSize(0), statusVersion(0), startTimeMs(0), endOffsetMs(0),
+      uploadIdPrefixRef(0), dataIdRef(0), uploadDataNameRef(0), patientIdRef(0),
+      regionRef(0), bucketNameRef(0), objectKeyDirRef(0), objectKeyNameRef(0),
+      localDirRef(0), localNameRef(0), errorMessageRef(0), coalescedIntoRef(0),
+      status(UPLOAD_PENDING), fileOperationType(BATCH_CREATE), confirmationAttempted(0) {}
+
+// Split a path into directory (including trailing separator) and file name
+// Both '/' (S3 keys) and '\' (Windows paths) are treated as separators
+static void splitPath(const String& path, String& directory, String& name) {
+    size_t lastSeparator = path.find_last_of("/\\");
+    if (lastSeparator == String::npos) {
+        directory.clear();
+        name = path;
+    } else {
+        directory = path.substr(0, lastSeparator + 1);
+        name = path.substr(lastSeparator + 1);
+    }
+}
+
+static long long toMilliseconds(const std::chrono::steady_clock::time_point& timePoint) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(timePoint.time_since_epoch()).count();
+}
+
+static std::chrono::steady_clock::time_point fromMilliseconds(long long milliseconds) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::milliseconds(milliseconds)));
+}
+
+ArchivedUploadRecord UploadArchive::archive(const FileUploadTaskInfo& task) {
+    ArchivedUploadRecord record;
+
+    // uploadId = dataId + "_" + timestamp; keep the prefix interned and the timestamp packed
+    String uploadIdDataId;
+    long long uploadTimestamp = 0;
+    if (splitUploadId(task.uploadId, uploadIdDataId, uploadTimestamp)) {
+        record.uploadIdPrefixRef = strings_.acquire(getUploadIdPrefixByDataId(uploadIdDataId));
+        record.uploadTimestamp = uploadTimestamp;
+    } else {
+        // Not in the expected format - keep the whole id, -1 marks "no timestamp suffix"
+        record.uploadIdPrefixRef = strings_.acquire(task.uploadId);
+        record.uploadTimestamp = -1;
+    }
+
+    record.totalSize = task.totalSize;
+    record.statusVersion = task.statusVersion;
+    record.startTimeMs = toMilliseconds(task.startTime);
+    if (task.endTime.time_since_epoch().count() > 0) {
+        long long endOffset = toMilliseconds(task.endTime) - record.startTimeMs;
+        if (endOffset < 0) endOffset = 0;
+        if (endOffset > 0xFFFFFFFELL) endOffset = 0xFFFFFFFELL;
+        record.endOffsetMs = static_cast<unsigned int>(endOffset) + 1;
+    }
+
+    String directory;
+    String name;
+    splitPath(task.s3ObjectKey, directory, name);
+    record.objectKeyDirRef = strings_.acquire(directory);
+    record.objectKeyNameRef = strings_.acquire(name);
+    splitPath(task.localFilePath, directory, name);
+    record.localDirRef = strings_.acquire(directory);
+    record.localNameRef = strings_.acquire(name);
+
+    record.dataIdRef = strings_.acquire(task.dataId);
+    record.uploadDataNameRef = strings_.acquire(task.uploadDataName);
+    record.patientIdRef = strings_.acquire(task.patientId);
+    record.regionRef = strings_.acquire(task.region);
+    record.bucketNameRef = strings_.acquire(task.bucketName);
+    record.errorMessageRef = strings_.acquire(task.errorMessage);
+    record.coalescedIntoRef = strings_.acquire(task.coalescedInto);
+
+    record.status = static_cast<unsigned char>(task.status);
+    record.fileOperationType = static_cast<unsigned char>(task.fileOperationType);
+    record.confirmationAttempted = task.confirmationAttempted ? 1 : 0;
+    return record;
+}
+
+String UploadArchive::restoreUploadId(const ArchivedUploadRecord& record) const {
+    if (record.uploadTimestamp < 0) {
+        return strings_.get(record.uploadIdPrefixRef);
+    }
+    return strings_.get(record.uploadIdPrefixRef) + std::to_string(record.uploadTimestamp);
+}
+
+std::shared_ptr<FileUploadTaskInfo> UploadArchive::restore(const ArchivedUploadRecord& record) const {
+    auto task = std::make_shared<FileUploadTaskInfo>();
+    task->uploadId = restoreUploadId(record);
+    task->status = static_cast<UploadStatus>(record.status);
+    task->totalSize = record.totalSize;
+    task->statusVersion = record.statusVersion;
+    task->errorMessage = strings_.get(record.errorMessageRef);
+    task->s3ObjectKey = strings_.get(record.objectKeyDirRef) + strings_.get(record.objectKeyNameRef);
+    task->localFilePath = strings_.get(record.localDirRef) + strings_.get(record.localNameRef);
+    task->startTime = fromMilliseconds(record.startTimeMs);
+    if (record.endOffsetMs > 0) {
+        task->endTime = fromMilliseconds(record.startTimeMs + record.endOffsetMs - 1);
+    }
+    task->dataId = strings_.get(record.dataIdRef);
+    task->uploadDataName = strings_.get(record.uploadDataNameRef);
+    task->patientId = strings_.get(record.patientIdRef);
+    task->confirmationAttempted = record.confirmationAttempted != 0;
+    task->fileOperationType = static_cast<FileOperationType>(record.fileOperationType);
+    task->region = strings_.get(record.regionRef);
+    task->bucketName = strings_.get(record.bucketNameRef);
+    task->coalescedInto = strings_.get(record.coalescedIntoRef);
+    return task;
+}
+
+void UploadArchive::release(const ArchivedUploadRecord& record) {
+    strings_.release(record.uploadIdPrefixRef);
+    strings_.release(record.dataIdRef);
+    strings_.release(record.uploadDataNameRef);
+    strings_.release(record.patientIdRef);
+    strings_.release(record.regionRef);
+    strings_.release(record.bucketNameRef);
+    strings_.release(record.objectKeyDirRef);
+    strings_.release(record.objectKeyNameRef);
+    strings_.release(record.localDirRef);
+    strings_.release(record.localNameRef);
+    strings_.release(record.errorMessageRef);
+    strings_.release(record.coalescedIntoRef);
+}
@@ -0,0 +1,121 @@
+#ifndef UPLOAD_ARCHIVE_H
+#define UPLOAD_ARCHIVE_H
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct FileUploadTaskInfo;
+
+// Reference-counted string pool
+// Values shared by many upload records (region, bucket, patientId, dataId, directories,
+// common error messages) are stored once and referenced by a 32-bit index.
+// Thread-safety: none - AsyncUploadManager calls it under upload_data_map_mutex_.
+class StringInterner {
+public:
+    typedef unsigned int Ref;
+
+    // Reference to the empty string (never allocated, never released)
+    static const Ref EMPTY_REF = 0;
+
+    StringInterner();
+
+    // Add a reference to value, storing it if not already present
+    Ref acquire(const std::string& value);
+
+    // Drop a reference; the string is freed when its last reference goes away
+    void release(Ref ref);
+
+    // Get the string for a reference
+    const std::string& get(Ref ref) const;
+
+    // Number of distinct strings currently stored
+    size_t size() const {
+        return lookup_.size();
+    }
+
+private:
+    struct Entry {
+        // Points at the key stored in lookup_ (node-based map, so the address is stable)
+        const std::string* value;
+        unsigned int refCount;
+    };
+
+    std::unordered_map<std::string, Ref> lookup_;   // String -> reference
+    std::vector<Entry> entries_;                    // Reference -> string (index 0 = empty string)
+    std::vector<Ref> freeRefs_;                     // Released references available for reuse
+};
+
+// Compact form of a finished upload
+// Strings live in the archive's StringInterner; paths are split into an interned
+// directory part and file name so files of the same folder share their directory.
+struct ArchivedUploadRecord {
+    // Timestamp suffix of the uploadId (uploadId = prefix + timestamp)
+    long long uploadTimestamp;
+    // Total size of the uploaded file (in bytes)
+    long long totalSize;
+    // Status version of the last change to the upload
+    unsigned long long statusVersion;
+    // Upload start time (steady clock, milliseconds)
+    long long startTimeMs;
+    // End time as offset from start + 1 (0 = no end time recorded)
+    unsigned int endOffsetMs;
+    // Interned string references
+    StringInterner::Ref uploadIdPrefixRef;
+    StringInterner::Ref dataIdRef;
+    StringInterner::Ref uploadDataNameRef;
+    StringInterner::Ref patientIdRef;
+    StringInterner::Ref regionRef;
+    StringInterner::Ref bucketNameRef;
+    StringInterner::Ref objectKeyDirRef;
+    StringInterner::Ref objectKeyNameRef;
+    StringInterner::Ref localDirRef;
+    StringInterner::Ref localNameRef;
+    StringInterner::Ref errorMessageRef;
+    // uploadId of the task a coalesced upload was merged into (EMPTY_REF = uploaded itself)
+    StringInterner::Ref coalescedIntoRef;
+    // Packed UploadStatus / FileOperationType / confirmationAttempted
+    unsigned char status;
+    unsigned char fileOperationType;
+    unsigned char confirmationAttempted;
+
+    ArchivedUploadRecord();
+};
+
+// Converts finished FileUploadTaskInfo objects to and from ArchivedUploadRecord
+// Thread-safety: none - AsyncUploadManager calls it under upload_data_map_mutex_.
+class UploadArchive {
+public:
+    // Build a compact record from a finished task (acquires interned strings)
+    ArchivedUploadRecord archive(const FileUploadTaskInfo& task);
+
+    // Rebuild a read-only FileUploadTaskInfo for status queries
+    std::shared_ptr<FileUploadTaskInfo> restore(const ArchivedUploadRecord& record) const;
+
+    // Rebuild the uploadId of a record
+    std::string restoreUploadId(const ArchivedUploadRecord& record) const;
+
+    // Get the dataId of a record without restoring it
+    const std::string& dataIdOf(const ArchivedUploadRecord& record) const {
+        return strings_.get(record.dataIdRef);
+    }
+
+    // Get the error message of a record without restoring it
+    const std::string& errorMessageOf(const ArchivedUploadRecord& record) const {
+        return strings_.get(record.errorMessageRef);
+    }
+
+    // Release the interned strings of a record that is being dropped
+    void release(const ArchivedUploadRecord& record);
+
+    // Number of distinct strings held for archived records
+    size_t internedStringCount() const {
+        return strings_.size();
+    }
+
+private:
+    StringInterner strings_;
+};
+
+#endif // UPLOAD_ARCHIVE_H
@@ -0,0 +1,471 @@
+#include "S3Common.h"
+#include "upload_journal.h"
+#include <algorithm>
+
+using json = nlohmann::json;
+
+UploadJournal::UploadJournal()
+    : appendedSeq_(0),
+      durableSeq_(0),
+      failedSeq_(0),
+      durableRequestedSeq_(0),
+      submitOrder_(0),
+      recordsSinceCompaction_(0),
+      fileRecordCount_(0),
+      enabled_(false),
+      stopRequested_(false),
+      replayTaken_(false),
+      rewriteRequired_(false),
+      flushThreadRunning_(false),
+      file_(INVALID_HANDLE_VALUE) {}
+
+bool UploadJournal::open(const std::string& directory) {
+    if (directory.empty()) {
+        return false;
+    }
+
+    // Reopening (possibly elsewhere) starts from a clean state
+    close();
+
+    // Create the directory if needed (parent directories must already exist)
+    CreateDirectoryA(directory.c_str(), nullptr);
+    char lastChar = directory[directory.size() - 1];
+    std::string path = directory;
+    if (lastChar != '\\' && lastChar != '/') {
+        path += "\\";
+    }
+    path += JOURNAL_FILE_NAME;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    path_ = path;
+    live_.clear();
+    batchGroups_.clear();
+    replay_.clear();
+    pendingBatch_.clear();
+    replayTaken_ = false;
+    stopRequested_ = false;
+    rewriteRequired_ = false;
+    durableSeq_ = appendedSeq_;
+    failedSeq_ = appendedSeq_;
+    durableRequestedSeq_ = appendedSeq_;
+
+    // Step 1: Load existing records (a torn last line from a crash is skipped)
+    loadLocked();
+
+    // Step 2: Rewrite the file from the live set so replay starts small and any torn
+    // tail is dropped before new records are appended after it
+    std::vector<std::string> liveRecords = liveRecordsLocked();
+    {
+        std::lock_guard<std::mutex> fileLock(fileMutex_);
+        compact(liveRecords);
+        if (file_ == INVALID_HANDLE_VALUE) {
+            AWS_LOGSTREAM_ERROR("S3Upload", "Cannot open upload journal: " << path_);
+            return false;
+        }
+    }
+    fileRecordCount_ = liveRecords.size();
+    recordsSinceCompaction_ = 0;
+
+    // Step 3: Start the group-commit thread
+    enabled_ = true;
+    flushThreadRunning_ = true;
+    std::thread(&UploadJournal::flushThreadMain, this).detach();
+
+    AWS_LOGSTREAM_INFO("S3Upload", "Upload journal opened: " << path_ << ", unfinished uploads: " << replay_.size());
+    return true;
+}
+
+void UploadJournal::close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!enabled_) {
+        return;
+    }
+
+    // Let the flush thread write what is pending, then wait for it to exit
+    stopRequested_ = true;
+    flushCondition_.notify_all();
+    durableCondition_.wait(lock, [this] { return !flushThreadRunning_; });
+    enabled_ = false;
+
+    std::lock_guard<std::mutex> fileLock(fileMutex_);
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+}
+
+bool UploadJournal::isEnabled() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return enabled_;
+}
+
+bool UploadJournal::recordSubmit(const JournaledUpload& upload, bool waitDurable) {
+    json record = {
+        {"op", "submit"},
+        {"uploadId", upload.uploadId},
+        {"region", upload.region},
+        {"bucket", upload.bucketName},
+        {"key", upload.objectKey},
+        {"path", upload.localFilePath},
+        {"patientId", upload.patientId},
+        {"type", upload.fileOperationType}
+    };
+    std::string line = record.dump();
+
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!enabled_) {
+        return true;
+    }
+
+    unsigned long long seq = appendLocked(line);
+    applySubmitLocked(upload.uploadId, upload.fileOperationType, line);
+    if (!waitDurable) {
+        return true;
+    }
+
+    // Group commit: wake the flush thread now rather than after its interval. Records
+    // appended by other producers while it writes are committed together in its next batch.
+    durableRequestedSeq_ = (std::max)(durableRequestedSeq_, seq);
+    flushCondition_.notify_one();
+    durableCondition_.wait_for(lock, std::chrono::milliseconds(JOURNAL_DURABLE_WAIT_TIMEOUT_MS), [this, seq] {
+        return durableSeq_ >= seq || failedSeq_ >= seq || !enabled_;
+    });
+    return durableSeq_ >= seq;
+}
+
+void UploadJournal::recordState(const std::string& uploadId, int status) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Uploads submitted before the journal was enabled are not tracked
+    if (!enabled_ || live_.find(uploadId) == live_.end()) {
+        return;
+    }
+
+    json record = {
+        {"op", "state"},
+        {"uploadId", uploadId},
+        {"status", status}
+    };
+    appendLocked(record.dump());
+    applyStateLocked(uploadId, status);
+}
+
+std::vector<JournaledUpload> UploadJournal::takeUnfinishedUploads() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<JournaledUpload> result;
+    if (!replayTaken_) {
+        replayTaken_ = true;
+        result.swap(replay_);
+    }
+    return result;
+}
+
+void UploadJournal::loadLocked() {
+    std::ifstream input(path_.c_str(), std::ios::in | std::ios::binary);
+    if (!input.is_open()) {
+        return;
+    }
+
+    std::string line;
+    size_t lineCount = 0;
+    size_t skippedCount = 0;
+    while (std::getline(input, line)) {
+        if (!line.empty() && line[line.size() - 1] == '\r') {
+            line.erase(line.size() - 1);
+        }
+        if (line.empty()) {
+            continue;
+        }
+        lineCount++;
+
+        json record = json::parse(line, nullptr, false);
+        if (record.is_discarded() || !record.is_object() ||
+            !record.contains("op") || !record.contains("uploadId")) {
+            skippedCount++;
+            continue;
+        }
+
+        try {
+            std::string op = record["op"].get<std::string>();
+            std::string uploadId = record["uploadId"].get<std::string>();
+            if (op == "submit") {
+                applySubmitLocked(uploadId, record.value("type", 0), line);
+            } else if (op == "state") {
+                applyStateLocked(uploadId, record["status"].get<int>());
+            }
+        } catch (const std::exception&) {
+            skippedCount++;
+        }
+    }
+
+    if (skippedCount > 0) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Upload journal: skipped " << skippedCount << " unreadable record(s)");
+    }
+
+    // Build the replay list in submission order
+    std::vector<const LiveUpload*> ordered;
+    ordered.reserve(live_.size());
+    for (const auto& pair : live_) {
+        ordered.push_back(&pair.second);
+    }
+    std::sort(ordered.begin(), ordered.end(), [](const LiveUpload* a, const LiveUpload* b) {
+        return a->order < b->order;
+    });
+
+    for (const LiveUpload* entry : ordered) {
+        json record = json::parse(entry->submitRecord, nullptr, false);
+        if (record.is_discarded()) {
+            continue;
+        }
+        JournaledUpload upload;
+        upload.uploadId = record.value("uploadId", "");
+        upload.region = record.value("region", "");
+        upload.bucketName = record.value("bucket", "");
+        upload.objectKey = record.value("key", "");
+        upload.localFilePath = record.value("path", "");
+        upload.patientId = record.value("patientId", "");
+        upload.fileOperationType = record.value("type", 0);
+        upload.status = entry->status;
+        replay_.push_back(upload);
+    }
+
+    AWS_LOGSTREAM_INFO("S3Upload", "Upload journal loaded " << lineCount << " record(s), "
+                      << replay_.size() << " unfinished upload(s)");
+}
+
+unsigned long long UploadJournal::appendLocked(const std::string& line) {
+    pendingBatch_ += line;
+    pendingBatch_ += "\n";
+    recordsSinceCompaction_++;
+    fileRecordCount_++;
+    return ++appendedSeq_;
+}
+
+void UploadJournal::applySubmitLocked(const std::string& uploadId, int fileOperationType, const std::string& line) {
+    // A resubmitted uploadId replaces its previous record
+    retireLocked(uploadId);
+
+    LiveUpload entry;
+    entry.submitRecord = line;
+    entry.status = UPLOAD_PENDING;
+    entry.order = ++submitOrder_;
+    long long timestamp = 0;
+    if (fileOperationType == BATCH_CREATE && splitUploadId(uploadId, entry.batchDataId, timestamp)) {
+        batchGroups_[entry.batchDataId].insert(uploadId);
+    } else {
+        entry.batchDataId.clear();
+    }
+    live_[uploadId] = entry;
+}
+
+void UploadJournal::applyStateLocked(const std::string& uploadId, int status) {
+    auto it = live_.find(uploadId);
+    if (it == live_.end()) {
+        return;
+    }
+
+    // A failed or cancelled file means its folder is never confirmed: drop the whole group,
+    // including files that already succeeded, so a replay cannot confirm a partial folder
+    if ((status == UPLOAD_FAILED || status == UPLOAD_CANCELLED) && !it->second.batchDataId.empty()) {
+        auto group = batchGroups_.find(it->second.batchDataId);
+        if (group != batchGroups_.end()) {
+            std::unordered_set<std::string> members;
+            members.swap(group->second);
+            batchGroups_.erase(group);
+            for (const std::string& memberId : members) {
+                live_.erase(memberId);
+            }
+        }
+        live_.erase(uploadId);
+        return;
+    }
+
+    // Uploads in a final state are never replayed
+    if (isFinalUploadStatus(status)) {
+        retireLocked(uploadId);
+    } else {
+        it->second.status = status;
+    }
+}
+
+void UploadJournal::retireLocked(const std::string& uploadId) {
+    auto it = live_.find(uploadId);
+    if (it == live_.end()) {
+        return;
+    }
+    if (!it->second.batchDataId.empty()) {
+        auto group = batchGroups_.find(it->second.batchDataId);
+        if (group != batchGroups_.end()) {
+            group->second.erase(uploadId);
+            if (group->second.empty()) {
+                batchGroups_.erase(group);
+            }
+        }
+    }
+    live_.erase(it);
+}
+
+std::vector<std::string> UploadJournal::liveRecordsLocked() const {
+    std::vector<std::pair<unsigned long long, const std::pair<const std::string, LiveUpload>*>> ordered;
+    ordered.reserve(live_.size());
+    for (const auto& pair : live_) {
+        ordered.push_back(std::make_pair(pair.second.order, &pair));
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const std::pair<unsigned long long, const std::pair<const std::string, LiveUpload>*>& a,
+                 const std::pair<unsigned long long, const std::pair<const std::string, LiveUpload>*>& b) {
+                  return a.first < b.first;
+              });
+
+    std::vector<std::string> records;
+    records.reserve(ordered.size() * 2);
+    for (const auto& item : ordered) {
+        records.push_back(item.second->second.submitRecord);
+        if (item.second->second.status != UPLOAD_PENDING) {
+            json state = {
+                {"op", "state"},
+                {"uploadId", item.second->first},
+                {"status", item.second->second.status}
+            };
+            records.push_back(state.dump());
+        }
+    }
+    return records;
+}
+
+bool UploadJournal::openFileForAppend() {
+    file_ = CreateFileA(path_.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr,
+                        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER zero;
+    zero.QuadPart = 0;
+    SetFilePointerEx(file_, zero, nullptr, FILE_END);
+    return true;
+}
+
+bool UploadJournal::writeBatch(const std::string& batch) {
+    if (file_ == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    const char* data = batch.data();
+    size_t remaining = batch.size();
+    while (remaining > 0) {
+        DWORD written = 0;
+        if (!WriteFile(file_, data, static_cast<DWORD>(remaining), &written, nullptr) || written == 0) {
+            AWS_LOGSTREAM_ERROR("S3Upload", "Upload journal write failed, error: " << GetLastError());
+            return false;
+        }
+        data += written;
+        remaining -= written;
+    }
+    return FlushFileBuffers(file_) != 0;
+}
+
+bool UploadJournal::compact(const std::vector<std::string>& liveRecords) {
+    // Step 1: Write the live set to a temporary file and flush it
+    std::string tempPath = path_ + ".tmp";
+    HANDLE tempFile = CreateFileA(tempPath.c_str(), GENERIC_WRITE, 0, nullptr,
+                                  CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (tempFile == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    std::string content;
+    for (const auto& record : liveRecords) {
+        content += record;
+        content += "\n";
+    }
+
+    HANDLE originalFile = file_;
+    file_ = tempFile;
+    bool written = writeBatch(content);
+    file_ = originalFile;
+    CloseHandle(tempFile);
+    if (!written) {
+        DeleteFileA(tempPath.c_str());
+        return false;
+    }
+
+    // Step 2: Atomically replace the journal and reopen it for appending
+    if (file_ != INVALID_HANDLE_VALUE) {
+        CloseHandle(file_);
+        file_ = INVALID_HANDLE_VALUE;
+    }
+    bool replaced = MoveFileExA(tempPath.c_str(), path_.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+    if (!replaced) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Upload journal compaction failed, error: " << GetLastError());
+        DeleteFileA(tempPath.c_str());
+    }
+    return openFileForAppend() && replaced;
+}
+
+void UploadJournal::flushThreadMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Collect records for one flush interval, or commit right away when a submission
+        // waits for durability (and its record has not just failed to be written)
+        flushCondition_.wait_for(lock, std::chrono::milliseconds(JOURNAL_FLUSH_INTERVAL_MS), [this] {
+            return stopRequested_ || durableRequestedSeq_ > (std::max)(durableSeq_, failedSeq_);
+        });
+
+        bool compactNow = recordsSinceCompaction_ >= JOURNAL_COMPACTION_MIN_RECORDS &&
+                          fileRecordCount_ >= JOURNAL_COMPACTION_RATIO * (std::max)(live_.size(), static_cast<size_t>(1));
+        bool rewriteOnly = rewriteRequired_;
+        if (pendingBatch_.empty() && !compactNow && !rewriteOnly) {
+            if (stopRequested_) {
+                break;
+            }
+            continue;
+        }
+
+        std::string batch;
+        batch.swap(pendingBatch_);
+        unsigned long long batchSeq = appendedSeq_;
+        std::vector<std::string> liveRecords;
+        if (compactNow || rewriteOnly) {
+            liveRecords = liveRecordsLocked();
+        }
+
+        // Disk I/O happens without mutex_ so producers are never blocked by fsync
+        // After a failed write the file may end in a torn record, so it is rewritten from
+        // the live set instead of appended to (the live set reflects every appended record)
+        lock.unlock();
+        bool durable = false;
+        bool compacted = false;
+        {
+            std::lock_guard<std::mutex> fileLock(fileMutex_);
+            if (!rewriteOnly) {
+                durable = writeBatch(batch);
+            }
+            if (compactNow || rewriteOnly) {
+                compacted = compact(liveRecords);
+                durable = durable || compacted;
+            }
+        }
+        lock.lock();
+
+        if (compacted) {
+            AWS_LOGSTREAM_INFO("S3Upload", "Upload journal compacted: " << fileRecordCount_ << " -> " << liveRecords.size() << " record(s)");
+            fileRecordCount_ = liveRecords.size();
+            recordsSinceCompaction_ = 0;
+        }
+        if (durable) {
+            durableSeq_ = batchSeq;
+            rewriteRequired_ = false;
+        } else {
+            // Waiters for these records give up; the next round retries with a rewrite
+            AWS_LOGSTREAM_ERROR("S3Upload", "Upload journal batch could not be made durable, rewriting on the next flush");
+            failedSeq_ = batchSeq;
+            rewriteRequired_ = true;
+        }
+        durableCondition_.notify_all();
+        if (!durable && stopRequested_) {
+            break;
+        }
+    }
+
+    flushThreadRunning_ = false;
+    durableCondition_.notify_all();
+}
@@ -0,0 +1,158 @@
+#ifndef UPLOAD_JOURNAL_H
+#define UPLOAD_JOURNAL_H
+
+#include <windows.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Journal batching configuration
+// Appended records are written and flushed to disk as one batch every interval (right
+// away when a submission waits for durability)
+static const int JOURNAL_FLUSH_INTERVAL_MS = 50;
+// Maximum time UploadFileAsync waits for its submission record to become durable
+static const int JOURNAL_DURABLE_WAIT_TIMEOUT_MS = 2000;
+// Compact once this many records were appended since the last compaction...
+static const size_t JOURNAL_COMPACTION_MIN_RECORDS = 4096;
+// ...and the file holds at least this many records per unfinished upload
+static const size_t JOURNAL_COMPACTION_RATIO = 4;
+
+// Journal file name inside the configured directory
+static const char* const JOURNAL_FILE_NAME = "upload_journal.log";
+
+// Submission parameters of an unfinished upload, as recovered from the journal
+struct JournaledUpload {
+    std::string uploadId;
+    std::string region;
+    std::string bucketName;
+    std::string objectKey;
+    std::string localFilePath;
+    std::string patientId;
+    int fileOperationType;
+    // Last status recorded for the upload
+    int status;
+
+    JournaledUpload() : fileOperationType(0), status(0) {}
+};
+
+// Append-only write-ahead log of upload submissions and state transitions
+// One JSON object per line:
+//   {"op":"submit","uploadId":...,"region":...,"bucket":...,"key":...,"path":...,"patientId":...,"type":N}
+//   {"op":"state","uploadId":...,"status":N}
+// Records are buffered and written + FlushFileBuffers'd by a background thread in batches
+// (group commit). Submissions can wait for their batch to be durable, which starts the
+// batch immediately; records appended while it is written share the next flush. State
+// transitions don't wait. A batch that fails to write is retried by rewriting the file.
+// Uploads that reached a final state are dropped from the in-memory live set, and the file
+// is periodically rewritten from that set so replay stays proportional to unfinished work.
+// BATCH_CREATE uploads of a dataId are confirmed as one folder, so they are retired as a
+// group: once any of them fails or is cancelled, the whole group is dropped, and a replay
+// can never confirm the remaining files as a complete folder.
+class UploadJournal {
+public:
+    // Get singleton instance of the journal
+    static UploadJournal& getInstance() {
+        static UploadJournal instance;
+        return instance;
+    }
+
+    // Open (or create) the journal in directory and start the flush thread
+    // Existing records are loaded so they can be replayed with takeUnfinishedUploads()
+    // Returns false if the file cannot be opened
+    bool open(const std::string& directory);
+
+    // Flush pending records and close the journal
+    void close();
+
+    // True while the journal is open
+    bool isEnabled() const;
+
+    // Append a submission record
+    // If waitDurable is set, blocks until the record is on disk (or the wait times out)
+    // Returns false if the record could not be made durable in time
+    bool recordSubmit(const JournaledUpload& upload, bool waitDurable);
+
+    // Append a state transition record (never blocks on disk I/O)
+    void recordState(const std::string& uploadId, int status);
+
+    // Unfinished uploads loaded by open(), returned once (subsequent calls return nothing)
+    std::vector<JournaledUpload> takeUnfinishedUploads();
+
+private:
+    UploadJournal();
+    ~UploadJournal() = default;
+    UploadJournal(const UploadJournal&) = delete;
+    UploadJournal& operator=(const UploadJournal&) = delete;
+
+    // Load records from the journal file into the live set
+    // Assumes mutex_ is held
+    void loadLocked();
+
+    // Queue one serialized record for the next batch
+    // Returns the sequence number of the record; assumes mutex_ is held
+    unsigned long long appendLocked(const std::string& line);
+
+    // Update the live set for a submission / state record; assumes mutex_ is held
+    void applySubmitLocked(const std::string& uploadId, int fileOperationType, const std::string& line);
+    void applyStateLocked(const std::string& uploadId, int status);
+
+    // Drop an upload from the live set and its BATCH_CREATE group; assumes mutex_ is held
+    void retireLocked(const std::string& uploadId);
+
+    // Serialized live set in submission order; assumes mutex_ is held
+    std::vector<std::string> liveRecordsLocked() const;
+
+    // Open the journal file for appending; assumes fileMutex_ is held
+    bool openFileForAppend();
+
+    // Write and flush the pending batch; assumes fileMutex_ is held
+    bool writeBatch(const std::string& batch);
+
+    // Rewrite the journal from the live set; assumes fileMutex_ is held
+    bool compact(const std::vector<std::string>& liveRecords);
+
+    // Background thread: group commit + periodic compaction
+    void flushThreadMain();
+
+    // Entry of the live set
+    struct LiveUpload {
+        // Serialized submission record
+        std::string submitRecord;
+        // Last recorded status
+        int status;
+        // Submission order, used to keep replay FIFO
+        unsigned long long order;
+        // dataId of a BATCH_CREATE upload (empty for REAL_TIME_APPEND, which is confirmed per file)
+        std::string batchDataId;
+    };
+
+    mutable std::mutex mutex_;                    // Protects everything below except the file handle
+    std::condition_variable flushCondition_;      // Wakes the flush thread
+    std::condition_variable durableCondition_;    // Signalled when a batch is on disk
+    std::string pendingBatch_;                    // Records waiting to be written
+    unsigned long long appendedSeq_;              // Sequence number of the last appended record
+    unsigned long long durableSeq_;               // Sequence number of the last record on disk
+    unsigned long long failedSeq_;                // Sequence number of the last record of a failed batch
+    unsigned long long durableRequestedSeq_;      // Highest sequence number a submission waits for
+    unsigned long long submitOrder_;              // Counter for LiveUpload::order
+    size_t recordsSinceCompaction_;               // Records in the file beyond the last compaction
+    size_t fileRecordCount_;                      // Records currently in the file
+    bool enabled_;                                // Journal is open
+    bool stopRequested_;                          // Flush thread should exit
+    bool replayTaken_;                            // takeUnfinishedUploads() already called
+    bool rewriteRequired_;                        // Last batch failed; rewrite the file from the live set
+    bool flushThreadRunning_;                     // Flush thread has not exited yet
+    std::unordered_map<std::string, LiveUpload> live_;  // Unfinished uploads by uploadId
+    std::unordered_map<std::string, std::unordered_set<std::string>> batchGroups_;  // dataId -> live BATCH_CREATE uploadIds
+    std::vector<JournaledUpload> replay_;         // Unfinished uploads found at open()
+    std::string path_;                            // Journal file path
+
+    std::mutex fileMutex_;                        // Serializes file writes and compaction
+    HANDLE file_;                                 // Journal file handle (append position)
+};
+
+#endif // UPLOAD_JOURNAL_H
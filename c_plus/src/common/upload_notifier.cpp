@@ -0,0 +1,182 @@
+#include "S3Common.h"
+#include "upload_notifier.h"
+
+UploadNotifier::UploadNotifier()
+    : active_(false),
+      threadRunning_(false),
+      callback_(nullptr),
+      callbackUserData_(nullptr),
+      window_(nullptr),
+      windowMessage_(0),
+      event_(nullptr) {}
+
+bool UploadNotifier::isNotificationThread() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return threadRunning_ && std::this_thread::get_id() == threadId_;
+}
+
+void UploadNotifier::setCallback(UploadNotificationCallback callback, void* userData) {
+    // Wait for an in-flight delivery so the old callback is not invoked after we return
+    // (skipped when called from inside a callback, which already holds the delivery lock)
+    std::unique_lock<std::mutex> deliveryLock(deliveryMutex_, std::defer_lock);
+    if (!isNotificationThread()) {
+        deliveryLock.lock();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    callback_ = callback;
+    callbackUserData_ = userData;
+    updateSinksLocked();
+}
+
+void UploadNotifier::setWindowMessage(HWND window, UINT message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    window_ = window;
+    windowMessage_ = message;
+    updateSinksLocked();
+}
+
+bool UploadNotifier::setEvent(HANDLE event) {
+    HANDLE duplicated = nullptr;
+    if (event) {
+        if (!DuplicateHandle(GetCurrentProcess(), event, GetCurrentProcess(), &duplicated,
+                             0, FALSE, DUPLICATE_SAME_ACCESS)) {
+            AWS_LOGSTREAM_ERROR("S3Upload", "Cannot duplicate notification event handle, error: " << GetLastError());
+            return false;
+        }
+    }
+
+    HANDLE previous = nullptr;
+    {
+        std::unique_lock<std::mutex> deliveryLock(deliveryMutex_, std::defer_lock);
+        if (!isNotificationThread()) {
+            deliveryLock.lock();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        previous = event_;
+        event_ = duplicated;
+        updateSinksLocked();
+    }
+    if (previous) {
+        CloseHandle(previous);
+    }
+    return true;
+}
+
+void UploadNotifier::notifyStatus(const std::string& uploadId, const std::string& dataId, int status, long long totalBytes) {
+    if (!active_.load()) {
+        return;
+    }
+    UploadNotification notification;
+    notification.type = UPLOAD_NOTIFY_STATUS;
+    notification.uploadId = uploadId;
+    notification.dataId = dataId;
+    notification.status = status;
+    notification.bytesTransferred = (status == UPLOAD_SUCCESS || status == CONFIRM_SUCCESS) ? totalBytes : 0;
+    notification.totalBytes = totalBytes;
+    post(notification);
+}
+
+void UploadNotifier::notifyProgress(const std::string& uploadId, const std::string& dataId, int status,
+                                    long long bytesTransferred, long long totalBytes) {
+    if (!active_.load()) {
+        return;
+    }
+    UploadNotification notification;
+    notification.type = UPLOAD_NOTIFY_PROGRESS;
+    notification.uploadId = uploadId;
+    notification.dataId = dataId;
+    notification.status = status;
+    notification.bytesTransferred = bytesTransferred;
+    notification.totalBytes = totalBytes;
+    post(notification);
+}
+
+void UploadNotifier::post(const UploadNotification& notification) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!active_.load()) {
+            return;
+        }
+        // State transitions are never dropped; milestones are only hints
+        if (pending_.size() >= MAX_PENDING_NOTIFICATIONS && notification.type == UPLOAD_NOTIFY_PROGRESS) {
+            return;
+        }
+        pending_.push_back(notification);
+    }
+    queueCondition_.notify_one();
+}
+
+void UploadNotifier::updateSinksLocked() {
+    bool active = callback_ != nullptr || window_ != nullptr || event_ != nullptr;
+    active_ = active;
+    if (!active) {
+        // Nothing left to deliver to
+        pending_.clear();
+        queueCondition_.notify_one();
+        return;
+    }
+
+    if (!threadRunning_) {
+        threadRunning_ = true;
+        std::thread notificationThread(&UploadNotifier::threadMain, this);
+        threadId_ = notificationThread.get_id();
+        notificationThread.detach();
+        AWS_LOGSTREAM_INFO("S3Upload", "Upload notification thread started");
+    }
+}
+
+void UploadNotifier::threadMain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        queueCondition_.wait(lock, [this] { return !pending_.empty() || !active_.load(); });
+        if (pending_.empty()) {
+            // No sinks registered any more
+            break;
+        }
+
+        UploadNotification notification = pending_.front();
+        pending_.pop_front();
+        lock.unlock();
+
+        {
+            // Sinks are read under the delivery lock so unregistration waits for this call
+            std::lock_guard<std::mutex> deliveryLock(deliveryMutex_);
+            UploadNotificationCallback callback;
+            void* userData;
+            HWND window;
+            UINT message;
+            HANDLE event;
+            {
+                std::lock_guard<std::mutex> sinkLock(mutex_);
+                callback = callback_;
+                userData = callbackUserData_;
+                window = window_;
+                message = windowMessage_;
+                event = event_;
+            }
+
+            // Message and event first - the callback may replace (and close) the event handle
+            if (window) {
+                PostMessageA(window, message, static_cast<WPARAM>(notification.type), static_cast<LPARAM>(notification.status));
+            }
+            if (event) {
+                SetEvent(event);
+            }
+            if (callback) {
+                try {
+                    callback(notification.type, notification.uploadId.c_str(), notification.dataId.c_str(),
+                             notification.status, notification.bytesTransferred, notification.totalBytes, userData);
+                } catch (...) {
+                    AWS_LOGSTREAM_ERROR("S3Upload", "Exception thrown by upload notification callback");
+                }
+            }
+        }
+
+        lock.lock();
+    }
+
+    threadRunning_ = false;
+    threadId_ = std::thread::id();
+    AWS_LOGSTREAM_INFO("S3Upload", "Upload notification thread stopped");
+}
@@ -0,0 +1,120 @@
+#ifndef UPLOAD_NOTIFIER_H
+#define UPLOAD_NOTIFIER_H
+
+#include <windows.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// Kinds of upload notifications
+enum UploadNotificationType {
+    // Upload changed state (status holds the new UploadStatus)
+    UPLOAD_NOTIFY_STATUS = 0,
+    // Upload crossed a progress milestone (bytesTransferred of totalBytes sent)
+    UPLOAD_NOTIFY_PROGRESS = 1
+};
+
+// Progress notifications are sent every this many percent of a file
+static const int NOTIFY_PROGRESS_STEP_PERCENT = 10;
+// Maximum queued notifications; further progress notifications are dropped while full
+static const size_t MAX_PENDING_NOTIFICATIONS = 4096;
+
+// Host callback, invoked on the notification thread (never on a transfer thread)
+// uploadId and dataId are only valid for the duration of the call
+typedef void (__stdcall *UploadNotificationCallback)(
+    int notificationType,
+    const char* uploadId,
+    const char* dataId,
+    int status,
+    long long bytesTransferred,
+    long long totalBytes,
+    void* userData
+);
+
+// One queued notification
+struct UploadNotification {
+    int type;
+    std::string uploadId;
+    std::string dataId;
+    int status;
+    long long bytesTransferred;
+    long long totalBytes;
+};
+
+// Delivers upload state transitions and progress milestones to the host application
+// Sinks: a __stdcall callback, a window message (PostMessage) and/or an event (SetEvent).
+// Producers (AsyncUploadManager::updateProgress, the transfer's progress handler) only
+// append to a queue; a dedicated notification thread delivers in order, so a slow host
+// never stalls a transfer. The thread runs while at least one sink is registered.
+class UploadNotifier {
+public:
+    // Get singleton instance of the notifier
+    static UploadNotifier& getInstance() {
+        static UploadNotifier instance;
+        return instance;
+    }
+
+    // Register (or with nullptr, remove) the callback
+    // Once this returns the previous callback is no longer being invoked
+    void setCallback(UploadNotificationCallback callback, void* userData);
+
+    // Register (or with nullptr, remove) a window to receive
+    // PostMessage(window, message, notificationType, status)
+    void setWindowMessage(HWND window, UINT message);
+
+    // Register (or with nullptr, remove) an event that is set on every notification
+    // The handle is duplicated, so the caller may close its own copy
+    // Returns false if the handle cannot be duplicated
+    bool setEvent(HANDLE event);
+
+    // True while any sink is registered (producers skip all work otherwise)
+    bool hasSinks() const {
+        return active_.load();
+    }
+
+    // Queue a state transition notification
+    void notifyStatus(const std::string& uploadId, const std::string& dataId, int status, long long totalBytes);
+
+    // Queue a progress milestone notification
+    void notifyProgress(const std::string& uploadId, const std::string& dataId, int status,
+                        long long bytesTransferred, long long totalBytes);
+
+private:
+    UploadNotifier();
+    ~UploadNotifier() = default;
+    UploadNotifier(const UploadNotifier&) = delete;
+    UploadNotifier& operator=(const UploadNotifier&) = delete;
+
+    // Append a notification and wake the notification thread
+    void post(const UploadNotification& notification);
+
+    // Recompute active_ and start the notification thread if needed
+    // Assumes mutex_ is held
+    void updateSinksLocked();
+
+    // True when called on the notification thread (i.e. from inside a sink)
+    bool isNotificationThread() const;
+
+    // Notification thread main loop
+    void threadMain();
+
+    mutable std::mutex mutex_;                       // Protects the queue and sink registration
+    std::condition_variable queueCondition_;         // Wakes the notification thread
+    std::deque<UploadNotification> pending_;         // Notifications waiting for delivery
+    std::atomic<bool> active_;                       // Any sink registered
+    bool threadRunning_;                             // Notification thread has not exited yet
+    std::thread::id threadId_;                       // Id of the notification thread
+
+    UploadNotificationCallback callback_;            // Registered callback (nullptr = none)
+    void* callbackUserData_;                         // Passed back to the callback
+    HWND window_;                                    // Window receiving notification messages (nullptr = none)
+    UINT windowMessage_;                             // Message id posted to window_
+    HANDLE event_;                                   // Duplicated event handle (nullptr = none)
+
+    std::mutex deliveryMutex_;                       // Held while sinks are invoked (makes unregistration synchronous)
+};
+
+#endif // UPLOAD_NOTIFIER_H
@@ -0,0 +1,138 @@
+#ifndef UPLOAD_SLOT_MAP_H
+#define UPLOAD_SLOT_MAP_H
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// Generational slot map - dense storage addressed by compact 64-bit handles
+// Handle layout: high 32 bits = slot generation, low 32 bits = slot index.
+// A slot's generation is bumped every time it is freed, so a stale handle that
+// points at a reused slot is rejected instead of aliasing the new occupant.
+// Lookups are a bounds check plus a generation compare (no hashing, no string compares).
+//
+// Thread-safety: none - callers must provide their own locking.
+template <typename T>
+class GenerationalSlotMap {
+public:
+    typedef unsigned long long Handle;
+
+    // Handle value that never refers to a live slot (generations start at 1)
+    static const Handle INVALID_HANDLE = 0;
+
+    GenerationalSlotMap() : size_(0) {}
+
+    // Store a value and return the handle that addresses it
+    Handle insert(T value) {
+        uint32_t index;
+        if (!freeList_.empty()) {
+            index = freeList_.back();
+            freeList_.pop_back();
+        } else {
+            index = static_cast<uint32_t>(slots_.size());
+            slots_.push_back(Slot());
+        }
+
+        Slot& slot = slots_[index];
+        slot.occupied = true;
+        slot.value = std::move(value);
+        size_++;
+        return makeHandle(slot.generation, index);
+    }
+
+    // Get value by handle, nullptr if the handle is stale or unknown
+    T* get(Handle handle) {
+        Slot* slot = findSlot(handle);
+        return slot ? &slot->value : nullptr;
+    }
+
+    const T* get(Handle handle) const {
+        const Slot* slot = const_cast<GenerationalSlotMap*>(this)->findSlot(handle);
+        return slot ? &slot->value : nullptr;
+    }
+
+    // Release a slot - the handle (and any copy of it) becomes invalid
+    // Returns false if the handle was already stale
+    bool erase(Handle handle) {
+        Slot* slot = findSlot(handle);
+        if (!slot) {
+            return false;
+        }
+
+        slot->occupied = false;
+        slot->value = T();
+        // Keep generations within 31 bits so handles stay positive as signed 64-bit values
+        // (C# long / VB6 Currency); skip 0 so INVALID_HANDLE is never produced
+        slot->generation = (slot->generation + 1) & 0x7FFFFFFFu;
+        if (slot->generation == 0) {
+            slot->generation = 1;
+        }
+        freeList_.push_back(handleIndex(handle));
+        size_--;
+        return true;
+    }
+
+    // Number of live values
+    size_t size() const {
+        return size_;
+    }
+
+    // Visit every live value: func(Handle, T&)
+    template <typename Func>
+    void forEach(Func&& func) {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].occupied) {
+                func(makeHandle(slots_[i].generation, static_cast<uint32_t>(i)), slots_[i].value);
+            }
+        }
+    }
+
+    template <typename Func>
+    void forEach(Func&& func) const {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            if (slots_[i].occupied) {
+                func(makeHandle(slots_[i].generation, static_cast<uint32_t>(i)), slots_[i].value);
+            }
+        }
+    }
+
+private:
+    struct Slot {
+        uint32_t generation;
+        bool occupied;
+        T value;
+
+        Slot() : generation(1), occupied(false), value() {}
+    };
+
+    static Handle makeHandle(uint32_t generation, uint32_t index) {
+        return (static_cast<Handle>(generation) << 32) | index;
+    }
+
+    static uint32_t handleIndex(Handle handle) {
+        return static_cast<uint32_t>(handle & 0xFFFFFFFFu);
+    }
+
+    static uint32_t handleGeneration(Handle handle) {
+        return static_cast<uint32_t>(handle >> 32);
+    }
+
+    Slot* findSlot(Handle handle) {
+        uint32_t index = handleIndex(handle);
+        if (handle == INVALID_HANDLE || index >= slots_.size()) {
+            return nullptr;
+        }
+        Slot& slot = slots_[index];
+        if (!slot.occupied || slot.generation != handleGeneration(handle)) {
+            return nullptr;
+        }
+        return &slot;
+    }
+
+    std::vector<Slot> slots_;          // Dense slot storage, indexed by the low 32 bits of a handle
+    std::vector<uint32_t> freeList_;   // Indices of released slots available for reuse
+    size_t size_;                      // Number of occupied slots
+};
+
+#endif // UPLOAD_SLOT_MAP_H
@@ -0,0 +1,74 @@
+#ifndef UPLOAD_STATUS_BINARY_H
+#define UPLOAD_STATUS_BINARY_H
+
+#include <cstdint>
+
+// Fixed-layout binary status format (GetAsyncUploadStatusBinary)
+//
+// Buffer layout:
+//   UploadStatusBinaryHeader                       (headerSize bytes)
+//   UploadStatusBinaryRecord[uploadCount]          (recordSize bytes each, submission order)
+//   string table                                   (stringTableSize bytes)
+//
+// Strings are NUL-terminated and addressed by their byte offset into the string table;
+// offset 0 always holds the empty string. All 64-bit fields sit at multiples of 8 and
+// every struct size is a multiple of 8, so the layout is identical with 4- or 8-byte
+// packing (C# Pack = 4/8, VB6 user-defined types with Currency for 64-bit fields).
+// Readers must check magic, use headerSize / recordSize to step through the buffer, and
+// ignore fields beyond the ones they know; newer formats only append fields.
+
+// "HPUS" in little-endian byte order
+static const uint32_t UPLOAD_STATUS_BINARY_MAGIC = 0x53555048u;
+// Current format version
+// 2: transfer progress (bytesSent, throughput, ETA) appended to header and records
+static const uint16_t UPLOAD_STATUS_BINARY_VERSION = 2;
+
+// Record flags
+// Upload was merged into an earlier REAL_TIME_APPEND upload and mirrors its status
+static const int32_t UPLOAD_RECORD_FLAG_COALESCED = 0x1;
+
+// Group header (96 bytes)
+struct UploadStatusBinaryHeader {
+    uint32_t magic;                 // UPLOAD_STATUS_BINARY_MAGIC
+    uint16_t formatVersion;         // UPLOAD_STATUS_BINARY_VERSION
+    uint16_t headerSize;            // sizeof(UploadStatusBinaryHeader)
+    uint32_t recordSize;            // sizeof(UploadStatusBinaryRecord)
+    int32_t code;                   // UPLOAD_SUCCESS, or UPLOAD_FAILED (see errorMessageOffset)
+    int32_t overallStatus;          // Aggregated UploadStatus of the dataId
+    int32_t uploadCount;            // Number of records that follow
+    int32_t uploadedCount;          // Uploads in UPLOAD_SUCCESS
+    uint32_t stringTableOffset;     // Byte offset of the string table from the start of the buffer
+    uint32_t stringTableSize;       // Size of the string table in bytes
+    int32_t dataIdOffset;           // String table offset of the dataId
+    int32_t errorMessageOffset;     // String table offset of the first error message
+    int32_t reserved;               // Always 0
+    int64_t uploadedSize;           // Bytes of uploads in UPLOAD_SUCCESS
+    int64_t totalSize;              // Bytes of all uploads
+    int64_t statusVersion;          // Status version (see GetAsyncUploadStatusDelta)
+    int64_t bytesSent;              // Bytes that reached S3, including the running transfer (version 2)
+    int64_t bytesPerSecond;         // Current throughput of the running transfer (version 2)
+    int64_t etaSeconds;             // Estimated seconds until all uploads are transferred, -1 = unknown (version 2)
+};
+
+// Per-upload record (88 bytes)
+struct UploadStatusBinaryRecord {
+    int32_t status;                 // UploadStatus
+    int32_t flags;                  // UPLOAD_RECORD_FLAG_*
+    int64_t totalSize;              // File size in bytes
+    int64_t startTimeMs;            // Upload start (steady clock, milliseconds)
+    int64_t endTimeMs;              // Upload end (steady clock, milliseconds; 0 = not finished)
+    int64_t statusVersion;          // Status version of the last change to this upload
+    int64_t handle;                 // Upload handle (see UploadFileAsyncHandle)
+    int32_t uploadIdOffset;         // String table offsets
+    int32_t localFilePathOffset;
+    int32_t s3ObjectKeyOffset;
+    int32_t errorMessageOffset;
+    int64_t bytesSent;              // Bytes that reached S3 (version 2)
+    int64_t bytesPerSecond;         // Current throughput, 0 unless uploading (version 2)
+    int64_t etaSeconds;             // Estimated seconds until transferred, -1 = unknown (version 2)
+};
+
+static_assert(sizeof(UploadStatusBinaryHeader) == 96, "UploadStatusBinaryHeader layout changed");
+static_assert(sizeof(UploadStatusBinaryRecord) == 88, "UploadStatusBinaryRecord layout changed");
+
+#endif // UPLOAD_STATUS_BINARY_H
@@ -0,0 +1,350 @@
+#include "S3Common.h"
+#include "upload_status_board.h"
+#include <algorithm>
+#include <climits>
+
+// Readers give up on a slot that keeps changing after this many attempts
+static const int SEQLOCK_MAX_READ_ATTEMPTS = 1000;
+
+// Current wall clock as Unix epoch milliseconds
+static long long currentUnixTimeMs() {
+    FILETIME fileTime;
+    GetSystemTimeAsFileTime(&fileTime);
+    ULARGE_INTEGER ticks;
+    ticks.LowPart = fileTime.dwLowDateTime;
+    ticks.HighPart = fileTime.dwHighDateTime;
+    // FILETIME counts 100 ns intervals since 1601-01-01
+    return static_cast<long long>((ticks.QuadPart - 116444736000000000ULL) / 10000ULL);
+}
+
+// Copy a string into a fixed-size field, truncating and NUL-terminating it
+static void copyBoardString(char* field, size_t fieldSize, const std::string& value) {
+    size_t length = (std::min)(value.size(), fieldSize - 1);
+    memcpy(field, value.data(), length);
+    memset(field + length, 0, fieldSize - length);
+}
+
+// Check whether a process is still running
+static bool isProcessRunning(DWORD processId) {
+    HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, processId);
+    if (!process) {
+        return false;
+    }
+    bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+    CloseHandle(process);
+    return running;
+}
+
+// Copy size bytes guarded by a seqlock counter; false if the writer kept changing them
+static bool seqlockCopy(const volatile uint32_t* sequence, const void* source, void* target, size_t size) {
+    for (int attempt = 0; attempt < SEQLOCK_MAX_READ_ATTEMPTS; ++attempt) {
+        uint32_t before = *sequence;
+        if (before & 1) {
+            YieldProcessor();
+            continue;
+        }
+        MemoryBarrier();
+        memcpy(target, source, size);
+        MemoryBarrier();
+        if (*sequence == before) {
+            return true;
+        }
+    }
+    return false;
+}
+
+UploadStatusBoard::UploadStatusBoard()
+    : enabled_(false),
+      mapping_(nullptr),
+      header_(nullptr),
+      slots_(nullptr) {}
+
+bool UploadStatusBoard::open(const std::string& name, int slotCount) {
+    close();
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t mappingSize = sizeof(UploadStatusBoardHeader) + static_cast<size_t>(slotCount) * sizeof(UploadStatusBoardSlot);
+
+    // Step 1: Create the named mapping (backed by the paging file)
+    HANDLE mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+                                        0, static_cast<DWORD>(mappingSize), name.c_str());
+    if (!mapping) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Cannot create status board mapping " << name << ", error: " << GetLastError());
+        return false;
+    }
+    bool existed = GetLastError() == ERROR_ALREADY_EXISTS;
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, mappingSize);
+    if (!view) {
+        // An existing mapping smaller than requested cannot be reused
+        AWS_LOGSTREAM_ERROR("S3Upload", "Cannot map status board " << name << ", error: " << GetLastError());
+        CloseHandle(mapping);
+        return false;
+    }
+    UploadStatusBoardHeader* header = static_cast<UploadStatusBoardHeader*>(view);
+
+    // Step 2: A board left behind by a previous publisher may be reused, a live one not
+    // (monitors keep the mapping alive after the publisher exits)
+    if (existed && header->magic == UPLOAD_STATUS_BOARD_MAGIC && header->state == UPLOAD_STATUS_BOARD_ACTIVE &&
+        header->ownerProcessId != GetCurrentProcessId() && isProcessRunning(header->ownerProcessId)) {
+        AWS_LOGSTREAM_ERROR("S3Upload", "Status board " << name << " is published by process " << header->ownerProcessId);
+        UnmapViewOfFile(view);
+        CloseHandle(mapping);
+        return false;
+    }
+
+    // Step 3: Initialize header and slots; the header stays odd until it is complete
+    uint32_t sequence = existed && header->magic == UPLOAD_STATUS_BOARD_MAGIC ? header->sequence : 0;
+    header->sequence = sequence | 1;
+    MemoryBarrier();
+    UploadStatusBoardSlot* slots = reinterpret_cast<UploadStatusBoardSlot*>(header + 1);
+    for (int i = 0; i < slotCount; ++i) {
+        uint32_t slotSequence = existed ? slots[i].sequence : 0;
+        slots[i].sequence = slotSequence | 1;
+        MemoryBarrier();
+        memset(reinterpret_cast<char*>(&slots[i]) + sizeof(uint32_t), 0, sizeof(UploadStatusBoardSlot) - sizeof(uint32_t));
+        MemoryBarrier();
+        slots[i].sequence = (slotSequence | 1) + 1;
+    }
+    header->magic = UPLOAD_STATUS_BOARD_MAGIC;
+    header->formatVersion = UPLOAD_STATUS_BOARD_VERSION;
+    header->headerSize = static_cast<uint16_t>(sizeof(UploadStatusBoardHeader));
+    header->slotSize = static_cast<uint32_t>(sizeof(UploadStatusBoardSlot));
+    header->slotCount = static_cast<uint32_t>(slotCount);
+    header->ownerProcessId = GetCurrentProcessId();
+    header->state = UPLOAD_STATUS_BOARD_ACTIVE;
+    header->usedSlots = 0;
+    header->droppedUploads = 0;
+    header->reserved = 0;
+    header->updateTimeMs = currentUnixTimeMs();
+    header->reserved2[0] = 0;
+    header->reserved2[1] = 0;
+    MemoryBarrier();
+    header->sequence = (sequence | 1) + 1;
+
+    // Step 4: Reset the slot bookkeeping
+    mapping_ = mapping;
+    header_ = header;
+    slots_ = slots;
+    slotByHandle_.clear();
+    freeSlots_.clear();
+    for (int i = slotCount - 1; i >= 0; --i) {
+        freeSlots_.push_back(i);
+    }
+    slotHandles_.assign(slotCount, 0);
+    slotUpdateTimes_.assign(slotCount, 0);
+    slotFinished_.assign(slotCount, false);
+    enabled_ = true;
+
+    AWS_LOGSTREAM_INFO("S3Upload", "Status board " << name << " opened with " << slotCount << " slots");
+    return true;
+}
+
+void UploadStatusBoard::close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) {
+        return;
+    }
+    enabled_ = false;
+
+    // Leave the contents readable for monitors that still map the board
+    uint32_t sequence = header_->sequence;
+    header_->sequence = sequence + 1;
+    MemoryBarrier();
+    header_->state = UPLOAD_STATUS_BOARD_CLOSED;
+    header_->updateTimeMs = currentUnixTimeMs();
+    MemoryBarrier();
+    header_->sequence = sequence + 2;
+
+    UnmapViewOfFile(header_);
+    CloseHandle(mapping_);
+    header_ = nullptr;
+    slots_ = nullptr;
+    mapping_ = nullptr;
+    slotByHandle_.clear();
+    freeSlots_.clear();
+    slotHandles_.clear();
+    slotUpdateTimes_.clear();
+    slotFinished_.clear();
+    AWS_LOGSTREAM_INFO("S3Upload", "Status board closed");
+}
+
+int UploadStatusBoard::acquireSlotLocked(long long handle) {
+    auto existing = slotByHandle_.find(handle);
+    if (existing != slotByHandle_.end()) {
+        return existing->second;
+    }
+
+    int index = -1;
+    if (!freeSlots_.empty()) {
+        index = freeSlots_.back();
+        freeSlots_.pop_back();
+    } else {
+        // Reuse the least recently updated slot of a finished upload
+        for (size_t i = 0; i < slotHandles_.size(); ++i) {
+            if (slotFinished_[i] && (index < 0 || slotUpdateTimes_[i] < slotUpdateTimes_[index])) {
+                index = static_cast<int>(i);
+            }
+        }
+        if (index < 0) {
+            return -1;
+        }
+        slotByHandle_.erase(slotHandles_[index]);
+    }
+
+    slotByHandle_[handle] = index;
+    slotHandles_[index] = handle;
+    return index;
+}
+
+void UploadStatusBoard::writeSlotLocked(int index, const UploadStatusBoardSlot& values) {
+    UploadStatusBoardSlot& slot = slots_[index];
+    uint32_t sequence = slot.sequence;
+    slot.sequence = sequence + 1;
+    MemoryBarrier();
+    memcpy(reinterpret_cast<char*>(&slot) + sizeof(uint32_t), reinterpret_cast<const char*>(&values) + sizeof(uint32_t),
+           sizeof(UploadStatusBoardSlot) - sizeof(uint32_t));
+    MemoryBarrier();
+    slot.sequence = sequence + 2;
+}
+
+void UploadStatusBoard::touchHeaderLocked(long long nowMs) {
+    uint32_t sequence = header_->sequence;
+    header_->sequence = sequence + 1;
+    MemoryBarrier();
+    header_->usedSlots = static_cast<uint32_t>(slotByHandle_.size());
+    header_->updateTimeMs = nowMs;
+    MemoryBarrier();
+    header_->sequence = sequence + 2;
+}
+
+void UploadStatusBoard::publish(const UploadStatusBoardEntry& entry) {
+    if (!enabled_.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) {
+        return;
+    }
+
+    // Step 1: Find or allocate the slot of the upload
+    int index = acquireSlotLocked(entry.handle);
+    if (index < 0) {
+        uint32_t sequence = header_->sequence;
+        header_->sequence = sequence + 1;
+        MemoryBarrier();
+        header_->droppedUploads = header_->droppedUploads + 1;
+        MemoryBarrier();
+        header_->sequence = sequence + 2;
+        return;
+    }
+
+    // Step 2: Fill the slot values outside the mapping, then publish them under the seqlock
+    long long nowMs = currentUnixTimeMs();
+    UploadStatusBoardSlot values;
+    memset(&values, 0, sizeof(values));
+    values.inUse = 1;
+    values.status = entry.status;
+    values.flags = entry.flags;
+    values.handle = entry.handle;
+    values.totalSize = entry.totalSize;
+    values.bytesSent = entry.bytesSent;
+    values.bytesPerSecond = entry.bytesPerSecond;
+    values.etaSeconds = entry.etaSeconds;
+    values.statusVersion = static_cast<int64_t>(entry.statusVersion);
+    values.updateTimeMs = nowMs;
+    copyBoardString(values.uploadId, sizeof(values.uploadId), entry.uploadId);
+    copyBoardString(values.dataId, sizeof(values.dataId), entry.dataId);
+    size_t nameStart = entry.localFilePath.find_last_of("\\/");
+    copyBoardString(values.fileName, sizeof(values.fileName),
+                    nameStart == std::string::npos ? entry.localFilePath : entry.localFilePath.substr(nameStart + 1));
+    writeSlotLocked(index, values);
+
+    slotUpdateTimes_[index] = nowMs;
+    slotFinished_[index] = entry.finished;
+    touchHeaderLocked(nowMs);
+}
+
+void UploadStatusBoard::remove(long long handle) {
+    if (!enabled_.load()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!header_) {
+        return;
+    }
+    auto it = slotByHandle_.find(handle);
+    if (it == slotByHandle_.end()) {
+        return;
+    }
+    int index = it->second;
+    slotByHandle_.erase(it);
+
+    UploadStatusBoardSlot values;
+    memset(&values, 0, sizeof(values));
+    writeSlotLocked(index, values);
+    slotHandles_[index] = 0;
+    slotFinished_[index] = false;
+    freeSlots_.push_back(index);
+    touchHeaderLocked(currentUnixTimeMs());
+}
+
+// Copy a mapped board into buffer; returns the required size (0 if the view is not a board)
+static int copyBoardView(const void* view, unsigned char* buffer, int bufferSize) {
+    // Step 1: Copy a consistent header and validate the layout against the view size
+    MEMORY_BASIC_INFORMATION region;
+    if (VirtualQuery(view, &region, sizeof(region)) == 0 || region.RegionSize < sizeof(UploadStatusBoardHeader)) {
+        return 0;
+    }
+    const UploadStatusBoardHeader* header = static_cast<const UploadStatusBoardHeader*>(view);
+    UploadStatusBoardHeader headerCopy;
+    if (!seqlockCopy(&header->sequence, header, &headerCopy, sizeof(headerCopy)) ||
+        headerCopy.magic != UPLOAD_STATUS_BOARD_MAGIC ||
+        headerCopy.headerSize < sizeof(UploadStatusBoardHeader) ||
+        headerCopy.slotSize < sizeof(UploadStatusBoardSlot)) {
+        return 0;
+    }
+    unsigned long long boardSize = headerCopy.headerSize + static_cast<unsigned long long>(headerCopy.slotCount) * headerCopy.slotSize;
+    if (boardSize > region.RegionSize || boardSize > static_cast<unsigned long long>(INT_MAX)) {
+        return 0;
+    }
+    int requiredSize = static_cast<int>(boardSize);
+    if (requiredSize > bufferSize) {
+        return requiredSize;
+    }
+
+    // Step 2: Copy every slot under its own seqlock
+    memcpy(buffer, &headerCopy, sizeof(headerCopy));
+    memset(buffer + sizeof(headerCopy), 0, headerCopy.headerSize - sizeof(headerCopy));
+    const unsigned char* source = static_cast<const unsigned char*>(view) + headerCopy.headerSize;
+    unsigned char* target = buffer + headerCopy.headerSize;
+    for (uint32_t i = 0; i < headerCopy.slotCount; ++i) {
+        const UploadStatusBoardSlot* slot = reinterpret_cast<const UploadStatusBoardSlot*>(source);
+        if (!seqlockCopy(&slot->sequence, source, target, headerCopy.slotSize)) {
+            // Report a slot that never settled as free rather than torn
+            memset(target, 0, headerCopy.slotSize);
+        }
+        source += headerCopy.slotSize;
+        target += headerCopy.slotSize;
+    }
+    return requiredSize;
+}
+
+int UploadStatusBoard::read(const std::string& name, unsigned char* buffer, int bufferSize) {
+    // Map the board read-only; the publisher is never involved
+    HANDLE mapping = OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (!mapping) {
+        return 0;
+    }
+    const void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        return 0;
+    }
+
+    int requiredSize = copyBoardView(view, buffer, bufferSize);
+
+    UnmapViewOfFile(view);
+    CloseHandle(mapping);
+    return requiredSize;
+}
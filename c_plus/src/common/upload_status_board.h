@@ -0,0 +1,171 @@
+#ifndef UPLOAD_STATUS_BOARD_H
+#define UPLOAD_STATUS_BOARD_H
+
+#include <windows.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Shared-memory status board (EnableUploadStatusBoard / ReadUploadStatusBoard)
+//
+// The uploading process publishes one fixed-size slot per upload into a named file
+// mapping; monitor processes map it read-only (OpenFileMapping + MapViewOfFile with
+// FILE_MAP_READ) and read it without calling into the uploading process.
+//
+// Mapping layout:
+//   UploadStatusBoardHeader                    (headerSize bytes)
+//   UploadStatusBoardSlot[slotCount]           (slotSize bytes each)
+//
+// The header and every slot are protected by a seqlock: the writer makes sequence odd,
+// updates the fields and makes it even again. A reader copies the fields between two
+// reads of sequence and retries if it was odd or changed:
+//   do { s1 = sequence; copy slot; s2 = sequence; } while ((s1 & 1) || s1 != s2);
+// (with a full memory barrier after the first and before the second read).
+// A monitor can poll the header sequence alone to learn whether anything changed.
+// Strings are NUL-terminated and truncated to their field size. As with the binary
+// status format, readers step by headerSize / slotSize and ignore unknown trailing fields.
+
+// "HPSB" in little-endian byte order
+static const uint32_t UPLOAD_STATUS_BOARD_MAGIC = 0x42535048u;
+// Current board format version
+static const uint16_t UPLOAD_STATUS_BOARD_VERSION = 1;
+// Mapping name used when EnableUploadStatusBoard gets no name
+static const char* const DEFAULT_UPLOAD_STATUS_BOARD_NAME = "Local\\HippoUploadStatusBoard";
+// Slots allocated when EnableUploadStatusBoard gets slotCount <= 0
+static const int DEFAULT_UPLOAD_STATUS_BOARD_SLOTS = 1024;
+// Upper bound of slotCount (keeps the mapping below 32 MB)
+static const int MAX_UPLOAD_STATUS_BOARD_SLOTS = 100000;
+
+// Board states
+enum UploadStatusBoardState {
+    // Publisher closed the board; the contents are final
+    UPLOAD_STATUS_BOARD_CLOSED = 0,
+    // Publisher is updating the board
+    UPLOAD_STATUS_BOARD_ACTIVE = 1
+};
+
+// Board header (64 bytes)
+struct UploadStatusBoardHeader {
+    uint32_t magic;                 // UPLOAD_STATUS_BOARD_MAGIC
+    uint16_t formatVersion;         // UPLOAD_STATUS_BOARD_VERSION
+    uint16_t headerSize;            // sizeof(UploadStatusBoardHeader)
+    uint32_t slotSize;              // sizeof(UploadStatusBoardSlot)
+    uint32_t slotCount;             // Number of slots that follow
+    uint32_t ownerProcessId;        // Process id of the publisher
+    volatile int32_t state;         // UploadStatusBoardState
+    volatile uint32_t sequence;     // Seqlock of the header fields; advances by 2 after every slot update
+    volatile uint32_t usedSlots;    // Slots currently holding an upload
+    volatile uint32_t droppedUploads; // Uploads not published because every slot was busy
+    uint32_t reserved;              // Always 0
+    volatile int64_t updateTimeMs;  // Wall clock of the last update (Unix epoch, milliseconds)
+    int64_t reserved2[2];           // Always 0
+};
+
+// One upload (320 bytes)
+struct UploadStatusBoardSlot {
+    volatile uint32_t sequence;     // Seqlock counter, odd while the slot is being written
+    int32_t inUse;                  // 0 = free slot (ignore the other fields)
+    int32_t status;                 // UploadStatus
+    int32_t flags;                  // UPLOAD_RECORD_FLAG_* (see upload_status_binary.h)
+    int64_t handle;                 // Upload handle (see UploadFileAsyncHandle)
+    int64_t totalSize;              // File size in bytes
+    int64_t bytesSent;              // Bytes that reached S3
+    int64_t bytesPerSecond;         // Current throughput, 0 unless uploading
+    int64_t etaSeconds;             // Estimated seconds until transferred, -1 = unknown
+    int64_t statusVersion;          // Status version of the last change to this upload
+    int64_t updateTimeMs;           // Wall clock of the last update (Unix epoch, milliseconds)
+    char uploadId[80];
+    char dataId[64];
+    char fileName[104];             // File name part of the local path
+};
+
+static_assert(sizeof(UploadStatusBoardHeader) == 64, "UploadStatusBoardHeader layout changed");
+static_assert(sizeof(UploadStatusBoardSlot) == 320, "UploadStatusBoardSlot layout changed");
+
+// Values of one slot as published by the upload process
+struct UploadStatusBoardEntry {
+    long long handle;
+    int status;
+    int flags;
+    long long totalSize;
+    long long bytesSent;
+    long long bytesPerSecond;
+    long long etaSeconds;
+    unsigned long long statusVersion;
+    // Upload reached a final status (its slot may be reused when the board is full)
+    bool finished;
+    std::string uploadId;
+    std::string dataId;
+    std::string localFilePath;
+};
+
+// Publisher side of the status board
+// AsyncUploadManager publishes under its map lock; the board has its own mutex and never
+// calls back into the manager. All calls are no-ops while the board is not open.
+// A slot is bound to an upload handle until the upload is removed; when every slot is
+// busy, the least recently updated slot of a finished upload is reused.
+class UploadStatusBoard {
+public:
+    // Get singleton instance of the board
+    static UploadStatusBoard& getInstance() {
+        static UploadStatusBoard instance;
+        return instance;
+    }
+
+    // Create the named mapping and start publishing (closes a previously open board)
+    // Returns false if the mapping cannot be created
+    bool open(const std::string& name, int slotCount);
+
+    // Mark the board closed and release the mapping
+    void close();
+
+    // True while the board is open (callers skip building entries otherwise)
+    bool isEnabled() const {
+        return enabled_.load();
+    }
+
+    // Publish (add or update) the slot of an upload
+    void publish(const UploadStatusBoardEntry& entry);
+
+    // Free the slot of a removed upload
+    void remove(long long handle);
+
+    // Copy the header and all slots of a board (possibly owned by another process)
+    // Each slot is copied consistently using its seqlock. Returns the required size and
+    // copies only if it fits in bufferSize; returns 0 if the board does not exist.
+    static int read(const std::string& name, unsigned char* buffer, int bufferSize);
+
+private:
+    UploadStatusBoard();
+    ~UploadStatusBoard() = default;
+    UploadStatusBoard(const UploadStatusBoard&) = delete;
+    UploadStatusBoard& operator=(const UploadStatusBoard&) = delete;
+
+    // Find the slot of a handle, or allocate one (-1 if every slot is busy)
+    // Assumes mutex_ is held
+    int acquireSlotLocked(long long handle);
+
+    // Write a slot between the two seqlock increments
+    // Assumes mutex_ is held
+    void writeSlotLocked(int index, const UploadStatusBoardSlot& values);
+
+    // Record a board update in the header (usedSlots, droppedUploads, updateTimeMs)
+    // Assumes mutex_ is held
+    void touchHeaderLocked(long long nowMs);
+
+    std::mutex mutex_;                                   // Serializes writers
+    std::atomic<bool> enabled_;                          // Board is open
+    HANDLE mapping_;                                     // File mapping handle
+    UploadStatusBoardHeader* header_;                    // Writable view of the mapping
+    UploadStatusBoardSlot* slots_;                       // First slot in the view
+    std::unordered_map<long long, int> slotByHandle_;    // Upload handle -> slot index
+    std::vector<int> freeSlots_;                         // Unused slot indices
+    std::vector<long long> slotHandles_;                 // Per slot: upload handle (0 = free)
+    std::vector<long long> slotUpdateTimes_;             // Per slot: last update (for eviction)
+    std::vector<bool> slotFinished_;                     // Per slot: upload reached a final status
+};
+
+#endif // UPLOAD_STATUS_BOARD_H
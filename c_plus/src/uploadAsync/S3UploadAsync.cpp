@@ -1,7 +1,10 @@
 #include "../common/S3Common.h"
 #include "../common/request/s3_client_manager.h"
+#include "../common/upload_status_binary.h"
+#include "../common/json_writer.h"
+#include <aws/s3/model/HeadBucketRequest.h>
 #include <sstream>
-#include <iomanip>
+#include <algorithm>
 
 // Global worker thread management
 // Architecture: Single persistent worker thread + thread-safe task queue in AsyncUploadManager
@@ -13,31 +16,214 @@ static std::mutex g_workerThreadMutex;             // Protects worker thread cre
 static std::chrono::steady_clock::time_point g_lastTaskProcessedTime;  // Timestamp of last task completion
 static std::mutex g_lastTaskTimeMutex;             // Protects access to g_lastTaskProcessedTime
 
-// Ensure JSON strings are standards-compliant so that strict parsers (e.g. System.Text.Json)
-// receive valid data consistently across C#, VB, and other clients.
-static std::string JsonEscape(const std::string& rawString) {
-    std::ostringstream escapedStream;
-    for (unsigned char currentChar : rawString) {
-        switch (currentChar) {
-            case '\"': escapedStream << "\\\""; break;
-            case '\\': escapedStream << "\\\\"; break;
-            case '\b': escapedStream << "\\b"; break;
-            case '\f': escapedStream << "\\f"; break;
-            case '\n': escapedStream << "\\n"; break;
-            case '\r': escapedStream << "\\r"; break;
-            case '\t': escapedStream << "\\t"; break;
-            default:
-                if (currentChar < 0x20) {
-                    escapedStream << "\\u"
-                                  << std::uppercase << std::hex << std::setw(4) << std::setfill('0')
-                                  << static_cast<int>(currentChar);
-                    escapedStream << std::dec << std::nouppercase;
-                } else {
-                    escapedStream << static_cast<char>(currentChar);
-                }
+// Preparation stage
+// While the worker transfers one file, a preparation thread readies the next queued ones:
+// it opens the file once (the size is taken from the open stream) and gets the S3 client
+// for the patient, fetching credentials if needed. The worker then starts sending bytes
+// right away instead of paying for these steps between consecutive uploads.
+static const size_t PREPARE_AHEAD_TASKS = 2;                  // Queued uploads prepared ahead of the worker
+static const int PREPARE_THREAD_IDLE_TIMEOUT_SECONDS = 60;    // Preparation thread exits after this long without requests
+
+// Upload readied ahead of its transfer
+struct PreparedUpload {
+    std::shared_ptr<Aws::FStream> stream;                  // Open local file (null if it cannot be opened)
+    long long fileSize;                                    // Size taken from the stream, -1 if unknown
+    std::shared_ptr<S3ClientManager> clientManager;        // Shared manager for region and patient
+    bool ready;                                            // Preparation finished
+
+    PreparedUpload() : fileSize(-1), ready(false) {}
+};
+
+static std::mutex g_prepareMutex;                          // Protects the preparation state below
+static std::condition_variable g_prepareCondition;         // Signals new requests and finished preparations
+static std::deque<String> g_prepareRequests;               // Upload IDs waiting for preparation
+static std::unordered_map<String, std::shared_ptr<PreparedUpload>> g_preparedUploads;  // Upload ID -> prepared (or in progress) upload
+static bool g_prepareThreadRunning = false;                // Flag: true if the preparation thread is running
+static std::thread g_prepareThread;                        // The preparation thread object
+
+// Fetch temporary S3 credentials for a patient from the Hippo backend
+static nlohmann::json FetchS3Credentials(const std::string& patient_id) {
+    auto response = HippoClient::GetS3Credentials(patient_id);
+    AWS_LOGSTREAM_INFO("S3Upload", "get_s3_credentials: " << response);
+    return response;
+}
+
+// Open the local file of an upload and take its size from the open stream
+// A single open replaces the separate existence check, size query and reopen for the body
+static void OpenUploadFile(const String& localFilePath, PreparedUpload& prepared) {
+    prepared.stream = Aws::MakeShared<Aws::FStream>("PutObjectInputStream",
+                                                    localFilePath.c_str(),
+                                                    std::ios_base::in | std::ios_base::binary);
+    if (!prepared.stream->is_open()) {
+        prepared.stream.reset();
+        return;
+    }
+    prepared.stream->seekg(0, std::ios::end);
+    prepared.fileSize = static_cast<long long>(prepared.stream->tellg());
+    prepared.stream->seekg(0, std::ios::beg);
+}
+
+// Ready one upload: open its file and warm the S3 client of its patient
+// Failures are only logged; the worker reports them when it runs the upload
+static void PrepareUpload(const String& uploadId, PreparedUpload& prepared) {
+    auto progress = AsyncUploadManager::getInstance().getUpload(uploadId);
+    if (!progress || progress->shouldCancel.load() || progress->localFilePath.empty()) {
+        return;
+    }
+
+    OpenUploadFile(progress->localFilePath, prepared);
+    if (!IsSdkReady() || progress->region.empty() || progress->patientId.empty()) {
+        return;
+    }
+    try {
+        prepared.clientManager = S3ClientRegistry::instance().get_manager(progress->region, progress->patientId, FetchS3Credentials);
+        prepared.clientManager->get_client(progress->patientId);
+    } catch (const std::exception& e) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Preparing S3 client failed for upload ID: " << uploadId << " - " << e.what());
+    } catch (...) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Preparing S3 client failed for upload ID: " << uploadId);
+    }
+}
+
+// Preparation thread main function - prepares requested uploads one at a time
+// Exits after PREPARE_THREAD_IDLE_TIMEOUT_SECONDS without requests; RequestUploadPreparation
+// starts it again
+static void uploadPrepareThread() {
+    std::unique_lock<std::mutex> lock(g_prepareMutex);
+    while (true) {
+        if (!g_prepareCondition.wait_for(lock, std::chrono::seconds(PREPARE_THREAD_IDLE_TIMEOUT_SECONDS),
+                                         [] { return !g_prepareRequests.empty(); })) {
+            break;
+        }
+        String uploadId = g_prepareRequests.front();
+        g_prepareRequests.pop_front();
+        auto prepared = std::make_shared<PreparedUpload>();
+        g_preparedUploads[uploadId] = prepared;
+
+        // Prepare without the lock; the worker waits only if it needs this very upload
+        lock.unlock();
+        PrepareUpload(uploadId, *prepared);
+        lock.lock();
+        prepared->ready = true;
+        g_prepareCondition.notify_all();
+    }
+    g_prepareThreadRunning = false;
+}
+
+// Ask the preparation thread to ready the queued uploads that follow currentUploadId
+// Other prepared uploads (e.g. cancelled ones) are dropped, which closes their files;
+// the one of currentUploadId is kept for the worker to take
+static void RequestUploadPreparation(const String& currentUploadId, const std::vector<String>& uploadIds) {
+    std::vector<std::shared_ptr<PreparedUpload>> dropped;  // Released after the lock
+    std::lock_guard<std::mutex> lock(g_prepareMutex);
+
+    for (auto it = g_preparedUploads.begin(); it != g_preparedUploads.end();) {
+        if (it->second->ready && it->first != currentUploadId &&
+            std::find(uploadIds.begin(), uploadIds.end(), it->first) == uploadIds.end()) {
+            dropped.push_back(it->second);
+            it = g_preparedUploads.erase(it);
+        } else {
+            ++it;
         }
     }
-    return escapedStream.str();
+    g_prepareRequests.clear();
+    for (const auto& uploadId : uploadIds) {
+        if (g_preparedUploads.find(uploadId) == g_preparedUploads.end()) {
+            g_prepareRequests.push_back(uploadId);
+        }
+    }
+    if (g_prepareRequests.empty()) {
+        return;
+    }
+
+    if (!g_prepareThreadRunning) {
+        g_prepareThreadRunning = true;
+        // Clean up old thread handle if any
+        if (g_prepareThread.joinable()) {
+            g_prepareThread.detach();
+        }
+        g_prepareThread = std::thread(uploadPrepareThread);
+    }
+    g_prepareCondition.notify_all();
+}
+
+// Take the prepared state of an upload (waits if it is being prepared right now)
+// Returns null if the upload was not prepared ahead
+static std::shared_ptr<PreparedUpload> TakePreparedUpload(const String& uploadId) {
+    std::unique_lock<std::mutex> lock(g_prepareMutex);
+    auto request = std::find(g_prepareRequests.begin(), g_prepareRequests.end(), uploadId);
+    if (request != g_prepareRequests.end()) {
+        g_prepareRequests.erase(request);
+    }
+
+    auto it = g_preparedUploads.find(uploadId);
+    if (it == g_preparedUploads.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<PreparedUpload> prepared = it->second;
+    g_prepareCondition.wait(lock, [&prepared] { return prepared->ready; });
+    g_preparedUploads.erase(uploadId);
+    return prepared;
+}
+
+// Incremental confirmations in flight (used by the worker thread only)
+// REAL_TIME_APPEND uploads are confirmed on HippoClient's multiplexed request path, so the
+// worker starts the next upload instead of waiting for each backend round trip.
+// At most one confirmation per dataId is in flight: the appends of one recording reach the
+// backend in order, and only confirmations of different dataIds run concurrently.
+static const size_t MAX_PENDING_CONFIRMATIONS = 32;   // Older confirmations are awaited beyond this
+
+// Incremental confirmation waiting for its response
+struct PendingConfirmation {
+    String uploadId;
+    String dataId;
+    String s3ObjectKey;
+    HippoClient::AsyncResponse response;
+};
+
+static std::deque<PendingConfirmation> g_pendingConfirmations;
+
+// Wait for an incremental confirmation and record its outcome
+static void ApplyPendingConfirmation(PendingConfirmation& pending) {
+    auto& manager = AsyncUploadManager::getInstance();
+    bool incrementalConfirmSucceeded = FinishIncrementalUploadConfirmation(pending.response, pending.dataId, pending.s3ObjectKey);
+    AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation returned for ID: " << pending.uploadId << ", success: " << incrementalConfirmSucceeded);
+    if (incrementalConfirmSucceeded) {
+        manager.updateProgress(pending.uploadId, CONFIRM_SUCCESS);
+        AWS_LOGSTREAM_INFO("S3Upload", "Confirmation SUCCESS for ID: " << pending.uploadId);
+    } else {
+        manager.updateProgress(pending.uploadId, CONFIRM_FAILED);
+        AWS_LOGSTREAM_WARN("S3Upload", "Confirmation FAILED for ID: " << pending.uploadId);
+    }
+}
+
+// Wait for the confirmation of a dataId still in flight (if any)
+// Keeps the confirmations of one recording sequential
+static void CompletePendingConfirmationOfDataId(const String& dataId) {
+    for (auto it = g_pendingConfirmations.begin(); it != g_pendingConfirmations.end(); ++it) {
+        if (it->dataId == dataId) {
+            ApplyPendingConfirmation(*it);
+            g_pendingConfirmations.erase(it);
+            return;
+        }
+    }
+}
+
+// Apply the results of finished incremental confirmations
+// waitForAll: also wait for the ones still in flight
+// minimumCount: number of confirmations to complete even if they are still in flight (oldest first)
+static void CompletePendingConfirmations(bool waitForAll, size_t minimumCount = 0) {
+    size_t completed = 0;
+    for (auto it = g_pendingConfirmations.begin(); it != g_pendingConfirmations.end();) {
+        if (!waitForAll && completed >= minimumCount && !it->response.IsReady()) {
+            ++it;
+            continue;
+        }
+
+        ApplyPendingConfirmation(*it);
+        it = g_pendingConfirmations.erase(it);
+        ++completed;
+    }
 }
 
 // Upload processing function
@@ -80,25 +266,37 @@ void updateSingleFile(const String& uploadId) {
         }
 
         // Step 5: Verify AWS SDK is initialized
-        if (!g_isInitialized) {
+        // Waits for a background initialization started by SetCredentialAsync
+        if (!WaitForSdkReady(-1)) {
             manager.updateProgress(uploadId, UPLOAD_FAILED, "AWS SDK not initialized");
             return;
         }
 
-        // Step 6: Check if local file exists
-        if (!FileExists(localFilePath.c_str())) {
+        // Step 6: Open the local file (usually done by the preparation stage while the
+        // previous upload was transferring)
+        auto prepared = TakePreparedUpload(uploadId);
+        if (prepared && prepared->stream) {
+            // The file may have grown since it was prepared; seeking the open stream is cheap
+            prepared->stream->seekg(0, std::ios::end);
+            prepared->fileSize = static_cast<long long>(prepared->stream->tellg());
+            prepared->stream->seekg(0, std::ios::beg);
+        } else {
+            prepared = std::make_shared<PreparedUpload>();
+            OpenUploadFile(localFilePath, *prepared);
+        }
+        if (!prepared->stream) {
             manager.updateProgress(uploadId, UPLOAD_FAILED, "Local file does not exist");
             return;
         }
 
-        // Step 7: Get file size and validate
-        long fileSize = GetS3FileSize(localFilePath.c_str());
+        // Step 7: Validate the file size taken from the open stream
+        long long fileSize = prepared->fileSize;
         if (fileSize < 0) {
             manager.updateProgress(uploadId, UPLOAD_FAILED, "Cannot read file size");
             return;
         }
 
-        progress->totalSize = fileSize;
+        manager.setUploadTotalSize(uploadId, fileSize);
         AWS_LOGSTREAM_INFO("S3Upload", "File size: " << fileSize << " bytes");
 
         // Step 8: Check for cancellation again before heavy operations
@@ -108,16 +306,15 @@ void updateSingleFile(const String& uploadId) {
         }
 
         // Step 9: Create S3 client using S3ClientManager
-        // Define a lambda function to fetch S3 credentials for the patient
-        auto credentials_fetcher = [](const std::string& patient_id) -> nlohmann::json {
-            auto response = HippoClient::GetS3Credentials(patient_id);
-            AWS_LOGSTREAM_INFO("S3Upload", "get_s3_credentials: " << response);
-            return response;
-        };
-
-        // Initialize S3ClientManager with the specified region and credentials fetcher
-        AWS_LOGSTREAM_INFO("S3Upload", "Creating S3ClientManager for region: " << region << ", patientId: " << patientId);
-        auto s3_client_manager = std::make_shared<S3ClientManager>(region, credentials_fetcher);
+        // Get the shared S3ClientManager for this region and patient; files of the same
+        // folder reuse its credentials and connection pool instead of starting over
+        // The local reference keeps the manager alive even if the registry evicts it
+        // (the preparation stage usually got it, with fresh credentials, already)
+        std::shared_ptr<S3ClientManager> s3_client_manager = prepared->clientManager;
+        if (!s3_client_manager) {
+            AWS_LOGSTREAM_INFO("S3Upload", "Getting S3ClientManager for region: " << region << ", patientId: " << patientId);
+            s3_client_manager = S3ClientRegistry::instance().get_manager(region, patientId, FetchS3Credentials);
+        }
         
         // Get a refreshing client proxy that automatically handles credential refresh
         auto s3_client_proxy = s3_client_manager->get_refreshing_client(patientId);
@@ -143,30 +340,41 @@ void updateSingleFile(const String& uploadId) {
             return;
         }
 
-        // Step 12: Open file stream for reading
-        AWS_LOGSTREAM_INFO("S3Upload", "Opening file for reading: " << localFilePath);
-        auto inputData = Aws::MakeShared<Aws::FStream>("PutObjectInputStream",
-                                                       localFilePath.c_str(),
-                                                       std::ios_base::in | std::ios_base::binary);
-
-        if (!inputData->is_open()) {
-            std::string errorMsg = "Cannot open file for reading: " + localFilePath;
-            manager.updateProgress(uploadId, UPLOAD_FAILED, errorMsg);
-            AWS_LOGSTREAM_ERROR("S3Upload", errorMsg);
-            return;
-        }
-        
-        // Get file size from stream for logging (already got fileSize earlier, but verify consistency)
-        inputData->seekg(0, std::ios::end);
-        auto streamPos = inputData->tellg();
-        inputData->seekg(0, std::ios::beg);
-        long long streamFileSize = static_cast<long long>(streamPos);
+        // Step 12: Use the file stream opened in Step 6 as the request body
+        auto inputData = prepared->stream;
+        long long streamFileSize = fileSize;
         AWS_LOGSTREAM_INFO("S3Upload", "File opened successfully, size: " << streamFileSize << " bytes");
 
         // Step 13: Set request body and content type
         request.SetBody(inputData);
         request.SetContentType("application/octet-stream");
 
+        // Step 13.1: Track bytes sent and throughput, and report progress milestones
+        // (every NOTIFY_PROGRESS_STEP_PERCENT) to notification sinks
+        // The SDK invokes the handler on the transfer thread; rates are published once per
+        // sample window and the notifier only queues the event
+        long long attemptBytesSent = 0;
+        int lastMilestonePercent = 0;
+        TransferRateMeter rateMeter;
+        request.SetDataSentEventHandler([&](const Aws::Http::HttpRequest*, long long bytesSent) {
+            attemptBytesSent += bytesSent;
+            long long transferred = (std::min)(attemptBytesSent, streamFileSize);
+            if (rateMeter.update(transferred, std::chrono::steady_clock::now())) {
+                manager.updateTransferProgress(uploadId, transferred, rateMeter.instantBytesPerSecond(),
+                                               rateMeter.averageBytesPerSecond());
+            }
+
+            auto& notifier = UploadNotifier::getInstance();
+            if (streamFileSize <= 0 || !notifier.hasSinks()) {
+                return;
+            }
+            int milestonePercent = static_cast<int>(transferred * 100 / streamFileSize) / NOTIFY_PROGRESS_STEP_PERCENT * NOTIFY_PROGRESS_STEP_PERCENT;
+            if (milestonePercent > lastMilestonePercent) {
+                lastMilestonePercent = milestonePercent;
+                notifier.notifyProgress(uploadId, dataId, UPLOAD_UPLOADING, transferred, streamFileSize);
+            }
+        });
+
         AWS_LOGSTREAM_INFO("S3Upload", "Starting S3 PutObject operation - Bucket: " << bucketName 
                           << ", Key: " << objectKey << ", Size: " << streamFileSize << " bytes");
 
@@ -189,6 +397,10 @@ void updateSingleFile(const String& uploadId) {
             }
             
             // Execute the actual S3 upload operation
+            // Milestones already reported are not repeated when a retry starts over
+            attemptBytesSent = 0;
+            rateMeter.start(0, std::chrono::steady_clock::now());
+            manager.updateTransferProgress(uploadId, 0, 0, rateMeter.averageBytesPerSecond());
             AWS_LOGSTREAM_INFO("S3Upload", "Executing PutObject (attempt " << (retryCount + 1) << "/" << (MAX_UPLOAD_RETRIES + 1) << ") for upload ID: " << uploadId);
             auto outcome = s3_client_proxy->with_auto_refresh([&](std::shared_ptr<Aws::S3::S3Client> client) {
                 return client->PutObject(request);
@@ -252,27 +464,32 @@ void updateSingleFile(const String& uploadId) {
                               << " (REAL_TIME_APPEND=" << REAL_TIME_APPEND
                               << ", BATCH_CREATE=" << BATCH_CREATE << ")");
             
-            // 17.0: If REAL_TIME_APPEND, confirm immediately for this file
+            // 17.0: If REAL_TIME_APPEND, start the confirmation for this file
+            // It runs multiplexed with confirmations of other dataIds while the worker moves on
+            // to the next file; the result is applied by CompletePendingConfirmations. The
+            // previous confirmation of this dataId is awaited first so appends stay in order.
             if (progress->fileOperationType == REAL_TIME_APPEND) {
                 // For incremental upload, use the actual file name instead of the folder name
                 String actualFileName = extractFileName(progress->s3ObjectKey);
-                bool incrementalConfirmSucceeded = ConfirmIncrementalUploadFile(
+                CompletePendingConfirmationOfDataId(progress->dataId);
+                PendingConfirmation pending;
+                pending.uploadId = uploadId;
+                pending.dataId = progress->dataId;
+                pending.s3ObjectKey = progress->s3ObjectKey;
+                pending.response = BeginIncrementalUploadConfirmation(
                     progress->dataId,
                     actualFileName,  // Use actual file name for dataName and uploadDataName
                     progress->patientId,
                     progress->totalSize,
                     progress->s3ObjectKey
                 );
-                
-                AWS_LOGSTREAM_INFO("S3Upload", "ConfirmIncrementalUploadFile returned for ID: " << uploadId << ", success: " << incrementalConfirmSucceeded);
-                
-                if (incrementalConfirmSucceeded) {
-                    manager.updateProgress(uploadId, CONFIRM_SUCCESS);
-                    AWS_LOGSTREAM_INFO("S3Upload", "Confirmation SUCCESS for ID: " << uploadId);
-                    
-                } else {
-                    manager.updateProgress(uploadId, CONFIRM_FAILED);
-                    AWS_LOGSTREAM_WARN("S3Upload", "Confirmation FAILED for ID: " << uploadId);
+                g_pendingConfirmations.push_back(std::move(pending));
+                AWS_LOGSTREAM_INFO("S3Upload", "Incremental confirmation started for ID: " << uploadId
+                                  << ", in flight: " << g_pendingConfirmations.size());
+
+                // Bound the number of confirmations in flight
+                if (g_pendingConfirmations.size() > MAX_PENDING_CONFIRMATIONS) {
+                    CompletePendingConfirmations(false, 1);
                 }
             }
             
@@ -373,6 +590,17 @@ void uploadWorkerThread() {
     
     while (true) {
         try {
+            // Apply finished incremental confirmations; with nothing left to upload, wait for all of them
+            if (!g_pendingConfirmations.empty()) {
+                auto& manager = AsyncUploadManager::getInstance();
+                bool queueEmpty;
+                {
+                    std::lock_guard<std::mutex> queueLock(manager.getQueueMutex());
+                    queueEmpty = manager.getQueueSizeInternal() == 0;
+                }
+                CompletePendingConfirmations(queueEmpty);
+            }
+
             // Check idle timeout: if no task processed for 15 minutes, auto-shutdown
             {
                 std::lock_guard<std::mutex> lock(g_lastTaskTimeMutex);
@@ -395,6 +623,7 @@ void uploadWorkerThread() {
             
             // Wait for and get next task from queue
             String uploadId;
+            std::vector<String> nextUploadIds;
             {
                 auto& manager = AsyncUploadManager::getInstance();
                 std::unique_lock<std::mutex> lock(manager.getQueueMutex());
@@ -415,15 +644,26 @@ void uploadWorkerThread() {
                 
                 // Dequeue next task for processing (directly access queue to avoid deadlock)
                 uploadId = manager.dequeueUploadInternal();
+                nextUploadIds = manager.peekQueuedUploadsInternal(PREPARE_AHEAD_TASKS);
                 
                 AWS_LOGSTREAM_INFO("S3Upload", "Worker thread picked up task: " << uploadId 
                                   << ", remaining queue size: " << manager.getQueueSizeInternal());
             }
             // Lock is released here, allowing new tasks to be enqueued while we process this one
+
+            // Let the preparation stage ready the next uploads while this one transfers
+            RequestUploadPreparation(uploadId, nextUploadIds);
             
             // Process the upload task (this may take a while for large files)
             // All S3 upload logic is handled in updateSingleFile()
             updateSingleFile(uploadId);
+
+            // Return the task's budget and let parked uploads in
+            AsyncUploadManager::getInstance().releaseAdmission(uploadId);
+            AsyncUploadManager::getInstance().promoteDeferredUploads();
+
+            // Move finished uploads into their compact archived form
+            AsyncUploadManager::getInstance().compactFinishedUploads();
             
             // Update last task processed time after completing a task
             // This resets the idle timeout counter
@@ -482,10 +722,23 @@ void ensureWorkerThreadRunning() {
     // when new tasks are enqueued, so no need to reset it here
 }
 
-// Exported async upload function - adds upload task to global queue
-// A single persistent worker thread processes all upload tasks sequentially
-// Returns JSON with upload ID on success, error message on failure
-extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
+// Result of registering and enqueueing a single upload task
+struct UploadSubmitResult {
+    // UPLOAD_SUCCESS when the task was queued, UPLOAD_QUEUED_DEFERRED when parked, UPLOAD_FAILED otherwise
+    int code;
+    // uploadId on success, error message on failure
+    String message;
+    // Slot map handle of the queued upload (INVALID_UPLOAD_HANDLE on failure)
+    UploadHandle handle;
+
+    UploadSubmitResult(int resultCode, const String& resultMessage, UploadHandle uploadHandle = INVALID_UPLOAD_HANDLE)
+        : code(resultCode), message(resultMessage), handle(uploadHandle) {}
+};
+
+// Register an upload with the manager and hand it to the worker thread
+// Shared by the string-returning and handle-returning upload exports
+// Over-budget behaviour follows the admission policy (see ConfigureUploadAdmission)
+static UploadSubmitResult SubmitUploadTask(
     const char* region,
     const char* bucketName,
     const char* objectKey,
@@ -494,39 +747,63 @@ extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
     const char* patientId,
     int fileOperationType
 ) {
-    static std::string response;
-
     // Step 1: Validate input parameters
     if (!region || !bucketName || !objectKey || !localFilePath || !dataId || !patientId) {
-        response = create_response(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::INVALID_PARAMETERS));
-        return response.c_str();
+        return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::INVALID_PARAMETERS));
     }
 
-    // Step 2: Check if AWS SDK is initialized
-    if (!g_isInitialized) {
-        response = create_response(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::SDK_NOT_INITIALIZED));
-        return response.c_str();
+    // Step 2: Check if AWS SDK is initialized (or being initialized by SetCredentialAsync;
+    // the worker then holds the upload until the credentials are set)
+    if (!g_isInitialized && !IsSdkInitializing()) {
+        return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage(ErrorMessage::SDK_NOT_INITIALIZED));
     }
 
-    // Step 2.1: Check upload queue limit (max 100 uploads)
-    // Only count unfinished uploads (excluding successful ones)
+    // Step 2.1: Admission control - reserve budget for the file's bytes
+    // The file size comes from its attributes, so no file is opened here
     auto& manager = AsyncUploadManager::getInstance();
-    size_t totalUnfinishedUploads = manager.getUnfinishedUploads();
-    
-    if (totalUnfinishedUploads >= MAX_UPLOAD_LIMIT) {
-        // Check if there are existing uploads with the same dataId
-        auto existingUploads = manager.getAllUploadsByDataId(dataId);
-        
-        if (existingUploads.empty()) {
-            // No existing uploads with same dataId, reject new upload
-            std::string errorMsg = "Upload queue is full (" + std::to_string(totalUnfinishedUploads) +
-                                 " uploads). Please wait for some uploads to complete before trying again.";
-            response = create_response(UPLOAD_FAILED, formatErrorMessage("Upload limit exceeded", errorMsg));
-            AWS_LOGSTREAM_WARN("S3Upload", "Upload rejected due to queue limit: " << errorMsg);
-            return response.c_str();
+    auto& admission = manager.getAdmission();
+    long long fileBytes = QueryLocalFileSize(localFilePath);
+    if (fileBytes < 0) {
+        // Missing file is reported by the worker; it costs no transfer budget
+        fileBytes = 0;
+    }
+
+    bool admitted = false;
+    bool deferred = false;
+    AdmissionPolicy policy = admission.getPolicy();
+    if (policy == ADMISSION_DEFER) {
+        // Keep FIFO order: once uploads are parked, new ones queue up behind them
+        if (!manager.hasDeferredUploads() && admission.tryAdmit(fileBytes)) {
+            admitted = true;
+        } else {
+            deferred = true;
+        }
+    } else if (policy == ADMISSION_BLOCK) {
+        long timeoutMs = admission.getBlockTimeoutMs();
+        if (!admission.admitWithTimeout(fileBytes, timeoutMs)) {
+            std::string errorMsg = "Timed out after " + std::to_string(timeoutMs) + " ms waiting for upload capacity (" +
+                                   std::to_string(admission.getQueuedTasks()) + " uploads, " +
+                                   std::to_string(admission.getQueuedBytes()) + " bytes queued)";
+            AWS_LOGSTREAM_WARN("S3Upload", "Upload rejected by admission control: " << errorMsg);
+            return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage("Upload limit exceeded", errorMsg));
+        }
+        admitted = true;
+    } else {
+        admitted = admission.tryAdmit(fileBytes);
+        if (!admitted) {
+            if (!manager.hasUploadsForDataId(dataId)) {
+                // No existing uploads with same dataId, reject new upload
+                std::string errorMsg = "Upload queue is full (" + std::to_string(admission.getQueuedTasks()) + " uploads, " +
+                                       std::to_string(admission.getQueuedBytes()) +
+                                       " bytes). Please wait for some uploads to complete before trying again.";
+                AWS_LOGSTREAM_WARN("S3Upload", "Upload rejected due to queue limit: " << errorMsg);
+                return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage("Upload limit exceeded", errorMsg));
+            }
+            // Allow upload to continue if same dataId exists (folder upload scenario)
+            AWS_LOGSTREAM_INFO("S3Upload", "Upload queue full but allowing continuation for existing dataId: " << dataId);
+            admission.forceAdmit(fileBytes);
+            admitted = true;
         }
-        // Allow upload to continue if same dataId exists (folder upload scenario)
-        AWS_LOGSTREAM_INFO("S3Upload", "Upload queue full but allowing continuation for existing dataId: " << dataId);
     }
 
     try {
@@ -548,8 +825,10 @@ extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
         manager.addUpload(uploadId, strLocalFilePath, strObjectKey, strPatientId, strRegion, strBucketName);
 
         // Save operation type to progress
+        UploadHandle handle = INVALID_UPLOAD_HANDLE;
         if (auto uploadProgress = manager.getUpload(uploadId)) {
             uploadProgress->fileOperationType = (fileOperationType == REAL_TIME_APPEND) ? REAL_TIME_APPEND: BATCH_CREATE;
+            handle = uploadProgress->handle;
             AWS_LOGSTREAM_INFO("S3Upload", "Setting fileOperationType for uploadId: " << uploadId 
                               << ", input fileOperationType: " << fileOperationType 
                               << ", set to: " << uploadProgress->fileOperationType
@@ -559,14 +838,56 @@ extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
             AWS_LOGSTREAM_ERROR("S3Upload", "Failed to get upload progress for uploadId: " << uploadId);
         }
 
+        // Step 5.1: Journal the submission so it survives a crash or restart
+        // Concurrent submissions share one disk flush (group commit)
+        JournaledUpload journaled;
+        journaled.uploadId = uploadId;
+        journaled.region = strRegion;
+        journaled.bucketName = strBucketName;
+        journaled.objectKey = strObjectKey;
+        journaled.localFilePath = strLocalFilePath;
+        journaled.patientId = strPatientId;
+        journaled.fileOperationType = (fileOperationType == REAL_TIME_APPEND) ? REAL_TIME_APPEND : BATCH_CREATE;
+        if (!UploadJournal::getInstance().recordSubmit(journaled, true)) {
+            AWS_LOGSTREAM_WARN("S3Upload", "Upload journal did not confirm durability in time for: " << uploadId);
+        }
+
+        // Step 5.2: REAL_TIME_APPEND - merge into a queued upload of the same growing file
+        // That task has not read the file yet, so it uploads this submission's data too
+        String coalescedInto = manager.coalesceAppendUpload(uploadId);
+        if (!coalescedInto.empty()) {
+            // The surviving task holds the transfer budget
+            if (admitted) {
+                admission.release(fileBytes);
+                admitted = false;
+            }
+            AWS_LOGSTREAM_INFO("S3Upload", "Task coalesced: " << uploadId << " -> " << coalescedInto
+                              << ", handle: " << handle);
+            return UploadSubmitResult(UPLOAD_SUCCESS, uploadId, handle);
+        }
+
         // Step 6: Ensure worker thread is running (start if not running)
         // If thread is not started, this will create it automatically
         ensureWorkerThreadRunning();
 
+        // Step 6.1: Over budget with ADMISSION_DEFER - park the upload until budget frees up
+        // The worker promotes deferred uploads as earlier ones finish
+        if (deferred) {
+            manager.deferUpload(uploadId, fileBytes);
+            // Budget may have been returned between the admission check and now
+            manager.promoteDeferredUploads();
+            AWS_LOGSTREAM_INFO("S3Upload", "Task deferred: " << uploadId << ", handle: " << handle
+                              << ", queued bytes: " << admission.getQueuedBytes());
+            return UploadSubmitResult(UPLOAD_QUEUED_DEFERRED, uploadId, handle);
+        }
+
         // Step 7: Enqueue upload ID to queue
         // Critical section: Queue access must be protected by mutex
+        manager.setAdmittedBytes(uploadId, fileBytes);
+        admitted = false;  // Budget now travels with the task
         manager.enqueueUpload(uploadId);
         AWS_LOGSTREAM_INFO("S3Upload", "Task enqueued: " << uploadId 
+                          << ", handle: " << handle
                           << ", total pending tasks: " << manager.getQueueSize());
         
         // Step 7.1: Reset idle timeout timer since we have a new task
@@ -581,168 +902,493 @@ extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
         // If worker is busy processing, this has no effect (worker will see new task after current one)
         manager.getQueueCondition().notify_one();
 
-        // Step 8: Return success response with upload ID
+        // Step 8: Return upload ID and handle
         // Note: Upload hasn't started yet, it's just queued
-        // VB can use uploadId to query status later via GetAsyncUploadStatusBytes()
-        response = create_response(UPLOAD_SUCCESS, uploadId);
-        return response.c_str();
+        return UploadSubmitResult(UPLOAD_SUCCESS, uploadId, handle);
 
     } catch (const std::exception& e) {
         // Step 9: Handle exceptions during task queue addition
-        response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to enqueue upload task", e.what()));
-        return response.c_str();
+        if (admitted) admission.release(fileBytes);
+        return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage("Failed to enqueue upload task", e.what()));
     } catch (...) {
         // Step 10: Handle unknown exceptions
-        response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to enqueue upload task", ErrorMessage::UNKNOWN_ERROR));
-        return response.c_str();
+        if (admitted) admission.release(fileBytes);
+        return UploadSubmitResult(UPLOAD_FAILED, formatErrorMessage("Failed to enqueue upload task", ErrorMessage::UNKNOWN_ERROR));
     }
 }
 
-// Get async upload status as byte array - safer for VB6 interop
-// Returns the size of data copied to buffer, 0 on error
-extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusBytes(
-    const char* dataId, 
-    unsigned char* buffer, 
-    int bufferSize
+// Configure upload admission control
+// Budget covers uploads that are queued or transferring. New uploads are admitted until
+// either high watermark would be exceeded; admission then resumes only after both totals
+// drain to their low watermarks.
+// policy: ADMISSION_REJECT (0), ADMISSION_BLOCK (1) or ADMISSION_DEFER (2)
+// blockTimeoutMs: maximum wait per UploadFileAsync call with ADMISSION_BLOCK
+// Returns 1 on success, 0 if the parameters are invalid
+extern "C" S3UPLOAD_API int __stdcall ConfigureUploadAdmission(
+    int highWatermarkMB,
+    int lowWatermarkMB,
+    int highWatermarkTasks,
+    int lowWatermarkTasks,
+    int policy,
+    int blockTimeoutMs
 ) {
-    // Step 1: Validate parameters
-    if (!dataId || !buffer || bufferSize <= 0) {
+    if (highWatermarkMB <= 0 || lowWatermarkMB < 0 || lowWatermarkMB > highWatermarkMB ||
+        highWatermarkTasks <= 0 || lowWatermarkTasks < 0 || lowWatermarkTasks > highWatermarkTasks ||
+        policy < ADMISSION_REJECT || policy > ADMISSION_DEFER || blockTimeoutMs < 0) {
         return 0;
     }
 
-    // Step 2: Look up all uploads that match the dataId prefix
+    UploadAdmissionConfig config;
+    config.highWatermarkBytes = static_cast<long long>(highWatermarkMB) * 1024 * 1024;
+    config.lowWatermarkBytes = static_cast<long long>(lowWatermarkMB) * 1024 * 1024;
+    config.highWatermarkTasks = static_cast<size_t>(highWatermarkTasks);
+    config.lowWatermarkTasks = static_cast<size_t>(lowWatermarkTasks);
+    config.policy = static_cast<AdmissionPolicy>(policy);
+    config.blockTimeoutMs = blockTimeoutMs;
+
     auto& manager = AsyncUploadManager::getInstance();
-    auto allUploads = manager.getAllUploadsByDataId(dataId);
-    if (allUploads.empty()) {
-        // Return error JSON if no uploads found
-        std::string errorJson = create_response(UPLOAD_FAILED, formatErrorMessage("No uploads found with dataId"));
-        int dataSize = static_cast<int>(errorJson.size());
-        if (dataSize > bufferSize) dataSize = bufferSize;
-        memcpy(buffer, errorJson.c_str(), dataSize);
-        return dataSize;
+    manager.getAdmission().configure(config);
+    // Looser limits may let parked uploads in right away
+    manager.promoteDeferredUploads();
+
+    AWS_LOGSTREAM_INFO("S3Upload", "Upload admission configured - bytes: " << config.lowWatermarkBytes << "/" << config.highWatermarkBytes
+                      << ", tasks: " << config.lowWatermarkTasks << "/" << config.highWatermarkTasks
+                      << ", policy: " << policy << ", block timeout: " << blockTimeoutMs << " ms");
+    return 1;
+}
+
+// Configure background renewal of cached S3 credentials
+// Credentials are renewed in the background once lifetimePercent of their lifetime has
+// passed (and at the latest 5 minutes before they expire), so uploads do not wait for
+// the credential request. 0 disables the background renewal; credentials are then
+// only renewed when an upload finds them about to expire. Default: 75.
+// Renewal pauses for a patient that has not uploaded for a full credential lifetime
+// and resumes with its next upload.
+// Returns 1 on success, 0 if lifetimePercent is outside 0..99
+extern "C" S3UPLOAD_API int __stdcall ConfigureCredentialRefresh(int lifetimePercent) {
+    if (lifetimePercent < 0 || lifetimePercent > 99) {
+        return 0;
     }
 
-    try {
-        // Step 3: Check status of all uploads with this dataId
-        bool allCompleted = true;
-        bool anyFailed = false;
-        bool anyUploading = false;
-        std::string errorMessage = "";
-        long long totalSize = 0;
-        int uploadedCount = 0;
-        long long uploadedSize = 0;
-        
-        for (auto& progress : allUploads) {
-            totalSize += progress->totalSize;
-            
-            if (progress->status == UPLOAD_SUCCESS) {
-                uploadedCount++;
-                uploadedSize += progress->totalSize;
-            } else if (progress->status == UPLOAD_FAILED) {
-                anyFailed = true;
-                if (errorMessage.empty()) {
-                    errorMessage = progress->errorMessage;
-                }
-                allCompleted = false;
-            } else if (progress->status == UPLOAD_UPLOADING || progress->status == UPLOAD_PENDING || progress->status == UPLOAD_CANCELLED) {
-                anyUploading = true;
-                allCompleted = false;
+    S3ClientRegistry::instance().set_refresh_fraction(lifetimePercent / 100.0);
+    AWS_LOGSTREAM_INFO("S3Upload", "Background credential refresh at " << lifetimePercent << "% of lifetime");
+    return 1;
+}
+
+// Re-enqueue unfinished uploads recovered from the upload journal
+// Each upload keeps its original uploadId, so callers polling by uploadId keep working.
+// Replayed uploads restart from the beginning of the file (PutObject overwrites the object).
+int ReplayUploadJournal() {
+    if (!g_isInitialized || !UploadJournal::getInstance().isEnabled()) {
+        return 0;
+    }
+
+    std::vector<JournaledUpload> unfinished = UploadJournal::getInstance().takeUnfinishedUploads();
+    if (unfinished.empty()) {
+        return 0;
+    }
+
+    auto& manager = AsyncUploadManager::getInstance();
+    int replayed = 0;
+    for (const auto& upload : unfinished) {
+        try {
+            // Skip uploads that are already tracked in this process
+            if (manager.getUpload(upload.uploadId)) {
+                continue;
             }
-        }
-        
-        // Step 4: Determine overall status and handle folder confirmation
-        int overallStatus;
-        if (anyFailed) {
-            overallStatus = UPLOAD_FAILED;
-        } else if (allCompleted && !anyUploading) {
-            // Check confirmation status
-            bool allConfirmed = true;
-            bool anyConfirmFailed = false;
-            
-            for (auto& progress : allUploads) {
-                if (progress->status == CONFIRM_FAILED) {
-                    anyConfirmFailed = true;
-                    allConfirmed = false;
-                } else if (progress->status != CONFIRM_SUCCESS) {
-                    allConfirmed = false;
-                }
+
+            manager.addUpload(upload.uploadId, upload.localFilePath, upload.objectKey,
+                              upload.patientId, upload.region, upload.bucketName);
+            if (auto uploadProgress = manager.getUpload(upload.uploadId)) {
+                uploadProgress->fileOperationType = (upload.fileOperationType == REAL_TIME_APPEND) ? REAL_TIME_APPEND : BATCH_CREATE;
             }
-            
-            if (allConfirmed) {
-                overallStatus = CONFIRM_SUCCESS;
-            } else if (anyConfirmFailed) {
-                overallStatus = CONFIRM_FAILED;
-            } else {
-                overallStatus = UPLOAD_SUCCESS; // Upload completed, confirmation may be in progress
+
+            // Replayed appends of the same file collapse into one transfer as well
+            if (!manager.coalesceAppendUpload(upload.uploadId).empty()) {
+                replayed++;
+                continue;
             }
-        } else {
-            overallStatus = UPLOAD_UPLOADING;
-        }
 
-        // Step 5: Build JSON response with array of upload information and summary
-        int totalUploadCount = static_cast<int>(allUploads.size());
-        
-        std::ostringstream oss;
-        oss << "{"
-            << "\"code\":" << UPLOAD_SUCCESS << ","
-            << "\"status\":" << overallStatus << ","
-            << "\"uploadedCount\":" << uploadedCount << ","
-            << "\"uploadedSize\":" << uploadedSize << ","
-            << "\"totalSize\":" << totalSize << ","
-            << "\"totalUploadCount\":" << totalUploadCount << ","
-            << "\"errorMessage\":\"" << JsonEscape(errorMessage) << "\","
-            << "\"dataId\":\"" << JsonEscape(dataId) << "\","
-            << "\"uploads\":[";
-
-        // Add array of individual upload information
-        for (size_t i = 0; i < allUploads.size(); ++i) {
-            auto& progress = allUploads[i];
-            if (i > 0) oss << ",";
-            
-            // Convert time points to milliseconds since epoch
-            auto startTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                progress->startTime.time_since_epoch()).count();
-            
-            long long endTimeMs = 0;
-            if (progress->endTime.time_since_epoch().count() > 0) {
-                endTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    progress->endTime.time_since_epoch()).count();
+            // Recovered work was admitted before the restart, so it bypasses the watermarks
+            long long fileBytes = QueryLocalFileSize(upload.localFilePath);
+            if (fileBytes < 0) {
+                fileBytes = 0;
             }
-            
-            oss << "{"
-                << "\"uploadId\":\"" << JsonEscape(progress->uploadId) << "\","
-                << "\"localFilePath\":\"" << JsonEscape(progress->localFilePath) << "\","
-                << "\"s3ObjectKey\":\"" << JsonEscape(progress->s3ObjectKey) << "\","
-                << "\"status\":" << progress->status << ","
-                << "\"totalSize\":" << progress->totalSize << ","
-                << "\"errorMessage\":\"" << JsonEscape(progress->errorMessage) << "\","
-                << "\"startTime\":" << startTimeMs << ","
-                << "\"endTime\":" << endTimeMs
-                << "}";
+            manager.getAdmission().forceAdmit(fileBytes);
+            manager.setAdmittedBytes(upload.uploadId, fileBytes);
+            manager.enqueueUpload(upload.uploadId);
+            replayed++;
+        } catch (const std::exception& e) {
+            AWS_LOGSTREAM_ERROR("S3Upload", "Failed to replay journaled upload " << upload.uploadId << ": " << e.what());
         }
+    }
 
-        oss << "]}";
+    if (replayed > 0) {
+        ensureWorkerThreadRunning();
+        {
+            std::lock_guard<std::mutex> taskTimeLock(g_lastTaskTimeMutex);
+            g_lastTaskProcessedTime = std::chrono::steady_clock::now();
+        }
+        manager.getQueueCondition().notify_one();
+    }
 
-        std::string response = oss.str();
-        
-        // Step 5: Copy data to buffer (truncate if necessary)
-        int dataSize = static_cast<int>(response.size());
+    AWS_LOGSTREAM_INFO("S3Upload", "Replayed " << replayed << " unfinished upload(s) from the upload journal");
+    return replayed;
+}
+
+// Enable the upload journal (write-ahead log) in the given directory
+// Submissions and state transitions are appended to <directory>\upload_journal.log.
+// Uploads that were unfinished when the previous process exited are re-enqueued once
+// the SDK is initialized (immediately if SetCredential was already called).
+// Pass NULL or an empty string to disable the journal.
+// Returns 1 on success, 0 if the journal file cannot be opened
+extern "C" S3UPLOAD_API int __stdcall EnableUploadJournal(const char* directory) {
+    auto& journal = UploadJournal::getInstance();
+    if (!directory || directory[0] == '\0') {
+        journal.close();
+        AWS_LOGSTREAM_INFO("S3Upload", "Upload journal disabled");
+        return 1;
+    }
+
+    if (!journal.open(directory)) {
+        return 0;
+    }
+
+    ReplayUploadJournal();
+    return 1;
+}
+
+// Enable the warm-start credential cache (see credential_cache.h)
+// The JWT and unexpired S3 credentials are kept in directory, encrypted for the current
+// Windows user and account, so a restarted process skips Login and the first credential
+// request per patient. Call before SetCredential (a later call loads the cache of the
+// account already set).
+// directory: folder for the cache files (NULL or empty disables the cache; files are kept)
+// Returns 1 on success, 0 if the directory cannot be used
+extern "C" S3UPLOAD_API int __stdcall EnableCredentialCache(const char* directory) {
+    auto& cache = CredentialCache::getInstance();
+    if (!directory || directory[0] == '\0') {
+        cache.close();
+        AWS_LOGSTREAM_INFO("S3Upload", "Credential cache disabled");
+        return 1;
+    }
+    return cache.open(directory) ? 1 : 0;
+}
+
+// Warm the S3 path of an upload target in the background (see PrewarmUploadTarget)
+// Waits for the credentials, builds the registry's S3 client for the patient (fetching its
+// credentials) and sends HeadBucket so the client's own connection pool holds a kept-alive
+// connection to the bucket endpoint. The outcome of HeadBucket does not matter.
+static void prewarmUploadTargetThread(String region, String bucketName, String patientId) {
+    if (!WaitForSdkReady(-1)) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Upload target warm-up skipped: AWS SDK not initialized");
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    try {
+        auto clientManager = S3ClientRegistry::instance().get_manager(region, patientId, FetchS3Credentials);
+        auto client = clientManager->get_client(patientId);
+        Aws::S3::Model::HeadBucketRequest request;
+        request.SetBucket(bucketName.c_str());
+        auto outcome = client->HeadBucket(request);
+        auto elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        AWS_LOGSTREAM_INFO("S3Upload", "Upload target warmed in " << elapsedMs << " ms - bucket: " << bucketName
+                          << ", region: " << region << ", HeadBucket: " << (outcome.IsSuccess() ? "OK" : outcome.GetError().GetMessage()));
+    } catch (const std::exception& e) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Upload target warm-up failed for patientId: " << patientId << " - " << e.what());
+    } catch (...) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Upload target warm-up failed for patientId: " << patientId);
+    }
+}
+
+// Prepare the first upload to a bucket ahead of time
+// In the background (after SetCredential / SetCredentialAsync has set the credentials),
+// fetches the patient's S3 credentials, creates the S3 client that uploads for the
+// patient reuse, and opens its connection to the bucket endpoint.
+// Returns 1 if the warm-up was started, 0 on invalid parameters or if the SDK is not
+// initialized and no SetCredentialAsync is pending
+extern "C" S3UPLOAD_API int __stdcall PrewarmUploadTarget(const char* region, const char* bucketName, const char* patientId) {
+    if (!region || !bucketName || !patientId || !region[0] || !bucketName[0] || !patientId[0]) {
+        return 0;
+    }
+    if (!g_isInitialized && !IsSdkInitializing()) {
+        return 0;
+    }
+    try {
+        std::thread(prewarmUploadTargetThread, String(region), String(bucketName), String(patientId)).detach();
+    } catch (const std::exception& e) {
+        AWS_LOGSTREAM_WARN("S3Upload", "Cannot start upload target warm-up: " << e.what());
+        return 0;
+    }
+    return 1;
+}
+
+// Publish upload status to a named shared-memory board (layout in upload_status_board.h)
+// Other processes map the board read-only and read it without calling into this process;
+// see ReadUploadStatusBoard for a ready-made reader.
+// name: mapping name (NULL or empty for "Local\HippoUploadStatusBoard"; use a "Global\"
+//       name to share with services in other sessions)
+// slotCount: number of upload slots (<= 0 for 1024); once all are busy, slots of
+//            finished uploads are reused, least recently updated first
+// Returns 1 on success, 0 if the mapping cannot be created (e.g. another process publishes it)
+extern "C" S3UPLOAD_API int __stdcall EnableUploadStatusBoard(const char* name, int slotCount) {
+    std::string boardName = (name && name[0] != '\0') ? name : DEFAULT_UPLOAD_STATUS_BOARD_NAME;
+    if (slotCount <= 0) {
+        slotCount = DEFAULT_UPLOAD_STATUS_BOARD_SLOTS;
+    }
+    slotCount = (std::min)(slotCount, MAX_UPLOAD_STATUS_BOARD_SLOTS);
+
+    if (!UploadStatusBoard::getInstance().open(boardName, slotCount)) {
+        return 0;
+    }
+    AsyncUploadManager::getInstance().publishAllToStatusBoard();
+    return 1;
+}
+
+// Stop publishing to the status board
+// The board is marked closed; monitors that still map it keep the last contents
+extern "C" S3UPLOAD_API int __stdcall DisableUploadStatusBoard() {
+    UploadStatusBoard::getInstance().close();
+    return 1;
+}
+
+// Copy a status board (published by this or another process) into buffer
+// The header and every slot are copied consistently through their seqlocks.
+// name: mapping name (NULL or empty for the default name)
+// Returns the number of bytes the board needs; the data is copied only if it fits in
+// bufferSize (buffer may be NULL with bufferSize 0). Returns 0 if no board is published.
+extern "C" S3UPLOAD_API int __stdcall ReadUploadStatusBoard(const char* name, unsigned char* buffer, int bufferSize) {
+    if (bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        return 0;
+    }
+    std::string boardName = (name && name[0] != '\0') ? name : DEFAULT_UPLOAD_STATUS_BOARD_NAME;
+    return UploadStatusBoard::read(boardName, buffer, bufferSize);
+}
+
+// Exported async upload function - adds upload task to global queue
+// A single persistent worker thread processes all upload tasks sequentially
+// Returns JSON with upload ID on success (code UPLOAD_SUCCESS, or UPLOAD_QUEUED_DEFERRED
+// when parked by admission control), error message on failure
+extern "C" S3UPLOAD_API const char* __stdcall UploadFileAsync(
+    const char* region,
+    const char* bucketName,
+    const char* objectKey,
+    const char* localFilePath,
+    const char* dataId,
+    const char* patientId,
+    int fileOperationType
+) {
+    static std::string response;
+
+    // VB can use uploadId to query status later via GetAsyncUploadStatusBytes()
+    UploadSubmitResult result = SubmitUploadTask(region, bucketName, objectKey, localFilePath,
+                                                 dataId, patientId, fileOperationType);
+    response = create_response(result.code, result.message);
+    return response.c_str();
+}
+
+// Handle-returning variant of UploadFileAsync
+// Returns the upload handle (> 0) on success or deferral, 0 on failure (reason is logged)
+// No response string is built, so nothing is allocated for the caller to copy
+extern "C" S3UPLOAD_API long long __stdcall UploadFileAsyncHandle(
+    const char* region,
+    const char* bucketName,
+    const char* objectKey,
+    const char* localFilePath,
+    const char* dataId,
+    const char* patientId,
+    int fileOperationType
+) {
+    UploadSubmitResult result = SubmitUploadTask(region, bucketName, objectKey, localFilePath,
+                                                 dataId, patientId, fileOperationType);
+    if (result.code != UPLOAD_SUCCESS && result.code != UPLOAD_QUEUED_DEFERRED) {
+        AWS_LOGSTREAM_WARN("S3Upload", "UploadFileAsyncHandle failed: " << result.message);
+        return static_cast<long long>(INVALID_UPLOAD_HANDLE);
+    }
+    return static_cast<long long>(result.handle);
+}
+
+// Get the status of a single upload by handle
+// Returns the UploadStatus value, or -1 if the handle is unknown or stale
+extern "C" S3UPLOAD_API int __stdcall GetUploadStatusByHandle(long long handle) {
+    UploadStatus status;
+    if (!AsyncUploadManager::getInstance().getUploadStatusByHandle(static_cast<UploadHandle>(handle), status)) {
+        return -1;
+    }
+    return static_cast<int>(status);
+}
+
+// Request cancellation of a queued or running upload by uploadId
+// Returns 1 if the cancellation was requested, 0 if the upload is unknown or already finished
+extern "C" S3UPLOAD_API int __stdcall CancelAsyncUpload(const char* uploadId) {
+    if (!uploadId) {
+        return 0;
+    }
+    return AsyncUploadManager::getInstance().cancelUpload(uploadId) ? 1 : 0;
+}
+
+// Request cancellation of a queued or running upload by handle
+// Returns 1 if the cancellation was requested, 0 if the handle is unknown or already finished
+extern "C" S3UPLOAD_API int __stdcall CancelAsyncUploadByHandle(long long handle) {
+    return AsyncUploadManager::getInstance().cancelUploadByHandle(static_cast<UploadHandle>(handle)) ? 1 : 0;
+}
+
+// Aggregate the uploads of a dataId into the overall status and counters
+static UploadGroupSummary SummarizeUploads(const std::vector<std::shared_ptr<FileUploadTaskInfo>>& allUploads) {
+    UploadGroupSummary summary;
+    auto now = std::chrono::steady_clock::now();
+    for (auto& progress : allUploads) {
+        summary.add(progress->status, progress->totalSize, progress->errorMessage, getUploadTransferInfo(*progress, now));
+    }
+    summary.finish();
+    return summary;
+}
+
+// Write the summary fields shared by the full and delta status JSON (opening brace included)
+static void WriteStatusSummaryJson(JsonWriter& json, const std::string& dataId, const UploadGroupSummary& summary) {
+    json.beginObject()
+        .field("code", UPLOAD_SUCCESS)
+        .field("status", summary.overallStatus)
+        .field("uploadedCount", summary.uploadedCount)
+        .field("uploadedSize", summary.uploadedSize)
+        .field("totalSize", summary.totalSize)
+        .field("totalUploadCount", summary.totalUploadCount)
+        .field("errorMessage", summary.errorMessage)
+        .field("bytesSent", summary.bytesSent)
+        .field("bytesPerSecond", summary.bytesPerSecond)
+        .field("etaSeconds", summary.etaSeconds)
+        .field("dataId", dataId);
+}
+
+// Write the JSON object of a single upload
+static void WriteUploadEntryJson(JsonWriter& json, const FileUploadTaskInfo& progress) {
+    // Convert time points to milliseconds since epoch
+    auto startTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        progress.startTime.time_since_epoch()).count();
+    
+    long long endTimeMs = 0;
+    if (progress.endTime.time_since_epoch().count() > 0) {
+        endTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            progress.endTime.time_since_epoch()).count();
+    }
+    
+    UploadTransferInfo transfer = getUploadTransferInfo(progress, std::chrono::steady_clock::now());
+
+    json.beginObject()
+        .field("uploadId", progress.uploadId)
+        .field("localFilePath", progress.localFilePath)
+        .field("s3ObjectKey", progress.s3ObjectKey)
+        .field("status", static_cast<int>(progress.status))
+        .field("totalSize", static_cast<long long>(progress.totalSize))
+        .field("errorMessage", progress.errorMessage)
+        .field("startTime", static_cast<long long>(startTimeMs))
+        .field("endTime", endTimeMs)
+        .field("bytesSent", transfer.bytesSent)
+        .field("bytesPerSecond", transfer.bytesPerSecond)
+        .field("averageBytesPerSecond", transfer.averageBytesPerSecond)
+        .field("etaSeconds", transfer.etaSeconds)
+        .endObject();
+}
+
+// Build the status JSON of a dataId from its uploads (in submission order)
+// Format returned by GetAsyncUploadStatusBytes
+static void BuildUploadStatusJson(std::string& out, const std::string& dataId,
+                                  const std::vector<std::shared_ptr<FileUploadTaskInfo>>& allUploads) {
+    JsonWriter json(out);
+    WriteStatusSummaryJson(json, dataId, SummarizeUploads(allUploads));
+    json.key("uploads").beginArray();
+
+    // Add array of individual upload information
+    for (auto& progress : allUploads) {
+        WriteUploadEntryJson(json, *progress);
+    }
+
+    json.endArray().endObject();
+}
+
+// Get the cached status JSON of a dataId, rebuilding it if its status version or transfer
+// sample count changed
+// Returns nullptr if no uploads are tracked for the dataId
+static std::shared_ptr<const std::string> GetUploadStatusSnapshot(const std::string& dataId) {
+    // Step 1: Reuse the cached snapshot if nothing changed since it was built
+    auto& manager = AsyncUploadManager::getInstance();
+    unsigned long long version = 0;
+    unsigned long long sampleCount = 0;
+    std::shared_ptr<const std::string> snapshot = manager.getStatusSnapshot(dataId, version, sampleCount);
+    if (snapshot) {
+        return snapshot;
+    }
+
+    // Step 2: Look up all uploads that match the dataId
+    // The versions were read first, so a concurrent change only makes the snapshot stale
+    auto allUploads = manager.getAllUploadsByDataId(dataId);
+    if (version == 0 || allUploads.empty()) {
+        return nullptr;
+    }
+
+    // Step 3: Build the status JSON
+    // Serialized into the per-thread scratch buffer, then copied once into an exactly sized snapshot
+    std::string& scratch = JsonWriter::scratchBuffer();
+    BuildUploadStatusJson(scratch, dataId, allUploads);
+    snapshot = std::make_shared<const std::string>(scratch);
+
+    // Step 4: Cache it until the next status change or transfer sample
+    // While a transfer runs the snapshot also expires after a sample window, so a stalled
+    // transfer (no more samples) reports its rate dropping to 0
+    bool transferring = std::any_of(allUploads.begin(), allUploads.end(),
+        [](const std::shared_ptr<FileUploadTaskInfo>& progress) { return progress->status == UPLOAD_UPLOADING; });
+    manager.storeStatusSnapshot(dataId, version, sampleCount, transferring, snapshot);
+    return snapshot;
+}
+
+// Get async upload status as byte array - safer for VB6 interop
+// Returns the size of data copied to buffer, 0 on error
+// The JSON is truncated to bufferSize; use GetAsyncUploadStatusRequiredSize to size the
+// buffer, or GetAsyncUploadStatusPage to read large folders in pages
+// The JSON of each dataId is cached and only rebuilt after its status version changes or
+// a new transfer sample arrives (at most once per second), so repeated polls just copy
+// the cached bytes
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusBytes(
+    const char* dataId, 
+    unsigned char* buffer, 
+    int bufferSize
+) {
+    // Step 1: Validate parameters
+    if (!dataId || !buffer || bufferSize <= 0) {
+        return 0;
+    }
+
+    try {
+        // Step 2: Get the (cached) status JSON
+        std::shared_ptr<const std::string> snapshot = GetUploadStatusSnapshot(dataId);
+        if (!snapshot) {
+            // Return error JSON if no uploads found
+            std::string errorJson = create_response(UPLOAD_FAILED, formatErrorMessage("No uploads found with dataId"));
+            int dataSize = static_cast<int>(errorJson.size());
+            if (dataSize > bufferSize) dataSize = bufferSize;
+            memcpy(buffer, errorJson.c_str(), dataSize);
+            return dataSize;
+        }
+
+        // Step 3: Copy data to buffer (truncate if necessary)
+        int dataSize = static_cast<int>(snapshot->size());
         if (dataSize > bufferSize) {
             dataSize = bufferSize;
         }
         
-        memcpy(buffer, response.c_str(), dataSize);
+        memcpy(buffer, snapshot->c_str(), dataSize);
         return dataSize;
         
     } catch (const std::exception& e) {
-        // Step 6: Handle exceptions during status query
+        // Step 4: Handle exceptions during status query
         std::string errorJson = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", e.what()));
         int dataSize = static_cast<int>(errorJson.size());
         if (dataSize > bufferSize) dataSize = bufferSize;
         memcpy(buffer, errorJson.c_str(), dataSize);
         return dataSize;
     } catch (...) {
-        // Step 7: Handle unknown exceptions
+        // Step 5: Handle unknown exceptions
         std::string errorJson = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", ErrorMessage::UNKNOWN_ERROR));
         int dataSize = static_cast<int>(errorJson.size());
         if (dataSize > bufferSize) dataSize = bufferSize;
@@ -750,3 +1396,412 @@ extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusBytes(
         return dataSize;
     }
 }
+
+// Get the buffer size GetAsyncUploadStatusBytes needs for the complete JSON of a dataId
+// The JSON is cached, so a following GetAsyncUploadStatusBytes call returns the same bytes
+// unless the status or a transfer sample changes in between (at most once per second while
+// uploading; size again and retry if the result was truncated)
+// Returns 0 on invalid parameters or if the status cannot be built
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusRequiredSize(const char* dataId) {
+    if (!dataId) {
+        return 0;
+    }
+    try {
+        std::shared_ptr<const std::string> snapshot = GetUploadStatusSnapshot(dataId);
+        if (!snapshot) {
+            return static_cast<int>(create_response(UPLOAD_FAILED, formatErrorMessage("No uploads found with dataId")).size());
+        }
+        return static_cast<int>(snapshot->size());
+    } catch (...) {
+        return 0;
+    }
+}
+
+// Build one page of the status JSON of a dataId
+static void BuildUploadStatusPageJson(std::string& out, const DataIdStatusBatchEntry& entry, int offset, int limit) {
+    JsonWriter json(out);
+    WriteStatusSummaryJson(json, entry.dataId, entry.summary);
+    int nextOffset = offset + static_cast<int>(entry.uploads.size());
+    json.field("version", entry.version)
+        .field("membershipVersion", entry.membershipVersion)
+        .field("offset", offset)
+        .field("limit", limit)
+        .field("nextOffset", nextOffset < entry.summary.totalUploadCount ? nextOffset : -1)
+        .key("uploads").beginArray();
+    for (auto& progress : entry.uploads) {
+        WriteUploadEntryJson(json, *progress);
+    }
+    json.endArray().endObject();
+}
+
+// Get one page of the upload status of a dataId
+// offset: index of the first upload to return (submission order)
+// limit: maximum number of uploads to return (<= 0 for all remaining)
+// Response: the summary fields of GetAsyncUploadStatusBytes (computed over all uploads), plus
+//   "version": status version the page was read at (see GetAsyncUploadStatusDelta)
+//   "membershipVersion": advances only when uploads of the dataId are added or removed
+//   "offset", "limit": the requested window
+//   "nextOffset": offset of the next page, -1 after the last page
+//   "uploads": the uploads in the window
+// Every page is complete JSON. If "membershipVersion" differs between pages, uploads were
+// added or removed in between and paging should restart at offset 0. "version" also
+// advances on every status change, so it differs between pages of an active folder.
+// Returns the size of the page; the buffer is only filled when it is large enough,
+// so pass bufferSize 0 to query the size without copying
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusPage(
+    const char* dataId,
+    int offset,
+    int limit,
+    unsigned char* buffer,
+    int bufferSize
+) {
+    // Step 1: Validate parameters
+    if (!dataId || offset < 0 || bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        return 0;
+    }
+
+    // Step 2: Collect the summary and the requested uploads under one lock
+    std::string& json = JsonWriter::scratchBuffer();
+    try {
+        size_t uploadLimit = limit > 0 ? static_cast<size_t>(limit) : SIZE_MAX;
+        DataIdStatusBatchEntry entry = AsyncUploadManager::getInstance().getStatusPage(dataId, static_cast<size_t>(offset), uploadLimit);
+        if (entry.version == 0 || entry.summary.totalUploadCount == 0) {
+            json = create_response(UPLOAD_FAILED, formatErrorMessage("No uploads found with dataId"));
+        } else {
+            BuildUploadStatusPageJson(json, entry, offset, limit > 0 ? limit : 0);
+        }
+    } catch (const std::exception& e) {
+        json = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", e.what()));
+    } catch (...) {
+        json = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", ErrorMessage::UNKNOWN_ERROR));
+    }
+
+    // Step 3: Copy only complete data
+    int requiredSize = static_cast<int>(json.size());
+    if (requiredSize <= bufferSize) {
+        memcpy(buffer, json.data(), requiredSize);
+    }
+    return requiredSize;
+}
+
+// Get only the uploads of a dataId that changed after sinceVersion
+// Response: the summary fields of GetAsyncUploadStatusBytes, plus
+//   "version": pass this as sinceVersion on the next call
+//   "full": true if "uploads" holds every upload (first call, or uploads were removed since)
+//   "uploads": uploads whose state changed after sinceVersion
+// Pass sinceVersion = 0 to get the full list
+// Transfer samples (bytesSent, rates, ETA) do not advance the version; read them from
+// GetAsyncUploadStatusBytes or the status board while uploads are transferring
+// Returns the size of the response; the buffer is only filled when it is large enough,
+// so pass bufferSize 0 to query the size. If the response did not fit, call again with the
+// same sinceVersion and a larger buffer (the response may have grown in between)
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusDelta(
+    const char* dataId,
+    long long sinceVersion,
+    unsigned char* buffer,
+    int bufferSize
+) {
+    // Step 1: Validate parameters
+    if (!dataId || sinceVersion < 0 || bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        return 0;
+    }
+
+    std::string& response = JsonWriter::scratchBuffer();
+    try {
+        // Step 2: Summarize the dataId and copy only the uploads that changed
+        // Removed uploads cannot be expressed as changes, so "full" lists every upload then
+        bool full = true;
+        DataIdStatusBatchEntry entry = AsyncUploadManager::getInstance().getStatusDelta(
+            dataId, static_cast<unsigned long long>(sinceVersion), full);
+        if (entry.version == 0 || entry.summary.totalUploadCount == 0) {
+            response = create_response(UPLOAD_FAILED, formatErrorMessage("No uploads found with dataId"));
+        } else {
+            // Step 3: Build JSON with the summary and the changed uploads only
+            // Summary, version and uploads were read under one lock, so they are consistent
+            JsonWriter json(response);
+            WriteStatusSummaryJson(json, dataId, entry.summary);
+            json.field("version", entry.version)
+                .field("full", full)
+                .key("uploads").beginArray();
+            for (auto& progress : entry.uploads) {
+                WriteUploadEntryJson(json, *progress);
+            }
+            json.endArray().endObject();
+        }
+    } catch (const std::exception& e) {
+        response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", e.what()));
+    } catch (...) {
+        response = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", ErrorMessage::UNKNOWN_ERROR));
+    }
+
+    // Step 4: Copy only complete data
+    int requiredSize = static_cast<int>(response.size());
+    if (requiredSize <= bufferSize) {
+        memcpy(buffer, response.data(), requiredSize);
+    }
+    return requiredSize;
+}
+
+// Block until an upload of a dataId changes state, the whole group is finished, or timeoutMs elapses
+// Long-poll alternative to calling GetAsyncUploadStatusBytes in a sleep loop; the calling
+// thread sleeps on a condition variable and wakes as soon as a status changes.
+// Parameters:
+//   sinceVersion: version from the previous call or from GetAsyncUploadStatusDelta (0 = return immediately)
+//   newVersion: receives the current status version (may be NULL)
+// Returns STATUS_WAIT_CHANGED (1), STATUS_WAIT_FINISHED (2, every upload reached a final status),
+//         STATUS_WAIT_TIMEOUT (0) or STATUS_WAIT_UNKNOWN (-1, no uploads for the dataId / invalid parameters)
+extern "C" S3UPLOAD_API int __stdcall WaitForUploadStatusChange(
+    const char* dataId,
+    long long sinceVersion,
+    int timeoutMs,
+    long long* newVersion
+) {
+    if (!dataId || sinceVersion < 0 || timeoutMs < 0) {
+        return STATUS_WAIT_UNKNOWN;
+    }
+
+    unsigned long long version = 0;
+    int result = AsyncUploadManager::getInstance().waitForStatusChange(
+        dataId, static_cast<unsigned long long>(sinceVersion), timeoutMs, version);
+    if (newVersion) {
+        *newVersion = static_cast<long long>(version);
+    }
+    return result;
+}
+
+// Register a callback invoked on upload state transitions and progress milestones
+// The callback runs on a dedicated notification thread (never on a transfer thread);
+// pass NULL to unregister. After unregistering returns, the old callback is not called again.
+// Returns 1
+extern "C" S3UPLOAD_API int __stdcall RegisterUploadCallback(UploadNotificationCallback callback, void* userData) {
+    UploadNotifier::getInstance().setCallback(callback, userData);
+    return 1;
+}
+
+// Register a window that receives PostMessage(hwnd, message, notificationType, status)
+// for every notification; pass NULL to unregister
+// Returns 1
+extern "C" S3UPLOAD_API int __stdcall RegisterUploadWindowMessage(HWND hwnd, unsigned int message) {
+    UploadNotifier::getInstance().setWindowMessage(hwnd, message);
+    return 1;
+}
+
+// Register an event that is set for every notification; pass NULL to unregister
+// The handle is duplicated, so the caller may close its own copy
+// Returns 1 on success, 0 if the handle is invalid
+extern "C" S3UPLOAD_API int __stdcall RegisterUploadEvent(HANDLE eventHandle) {
+    return UploadNotifier::getInstance().setEvent(eventHandle) ? 1 : 0;
+}
+
+// Build the binary status of a dataId (see upload_status_binary.h)
+// code / errorMessage describe failures; uploads may be empty
+static std::string BuildUploadStatusBinary(const std::string& dataId,
+                                           const std::vector<std::shared_ptr<FileUploadTaskInfo>>& allUploads,
+                                           unsigned long long version, int code, const std::string& errorMessage) {
+    // String table - offset 0 is the shared empty string
+    std::string strings(1, '\0');
+    auto addString = [&strings](const std::string& value) -> int32_t {
+        if (value.empty()) {
+            return 0;
+        }
+        int32_t offset = static_cast<int32_t>(strings.size());
+        strings.append(value);
+        strings.push_back('\0');
+        return offset;
+    };
+
+    UploadGroupSummary summary = SummarizeUploads(allUploads);
+
+    UploadStatusBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = UPLOAD_STATUS_BINARY_MAGIC;
+    header.formatVersion = UPLOAD_STATUS_BINARY_VERSION;
+    header.headerSize = static_cast<uint16_t>(sizeof(UploadStatusBinaryHeader));
+    header.recordSize = static_cast<uint32_t>(sizeof(UploadStatusBinaryRecord));
+    header.code = code;
+    header.overallStatus = code == UPLOAD_SUCCESS ? summary.overallStatus : code;
+    header.uploadCount = static_cast<int32_t>(allUploads.size());
+    header.uploadedCount = summary.uploadedCount;
+    header.dataIdOffset = addString(dataId);
+    header.errorMessageOffset = addString(code == UPLOAD_SUCCESS ? summary.errorMessage : errorMessage);
+    header.uploadedSize = summary.uploadedSize;
+    header.totalSize = summary.totalSize;
+    header.statusVersion = static_cast<int64_t>(version);
+    header.bytesSent = summary.bytesSent;
+    header.bytesPerSecond = summary.bytesPerSecond;
+    header.etaSeconds = summary.etaSeconds;
+
+    std::vector<UploadStatusBinaryRecord> records(allUploads.size());
+    auto now = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < allUploads.size(); ++i) {
+        const FileUploadTaskInfo& progress = *allUploads[i];
+        UploadStatusBinaryRecord& record = records[i];
+        memset(&record, 0, sizeof(record));
+        record.status = progress.status;
+        record.flags = progress.coalescedInto.empty() ? 0 : UPLOAD_RECORD_FLAG_COALESCED;
+        record.totalSize = progress.totalSize;
+        record.startTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+            progress.startTime.time_since_epoch()).count();
+        if (progress.endTime.time_since_epoch().count() > 0) {
+            record.endTimeMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+                progress.endTime.time_since_epoch()).count();
+        }
+        record.statusVersion = static_cast<int64_t>(progress.statusVersion);
+        record.handle = static_cast<int64_t>(progress.handle);
+        record.uploadIdOffset = addString(progress.uploadId);
+        record.localFilePathOffset = addString(progress.localFilePath);
+        record.s3ObjectKeyOffset = addString(progress.s3ObjectKey);
+        record.errorMessageOffset = addString(progress.errorMessage);
+        UploadTransferInfo transfer = getUploadTransferInfo(progress, now);
+        record.bytesSent = transfer.bytesSent;
+        record.bytesPerSecond = transfer.bytesPerSecond;
+        record.etaSeconds = transfer.etaSeconds;
+    }
+
+    header.stringTableOffset = static_cast<uint32_t>(sizeof(header) + records.size() * sizeof(UploadStatusBinaryRecord));
+    header.stringTableSize = static_cast<uint32_t>(strings.size());
+
+    std::string result;
+    result.reserve(header.stringTableOffset + strings.size());
+    result.append(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!records.empty()) {
+        result.append(reinterpret_cast<const char*>(records.data()), records.size() * sizeof(UploadStatusBinaryRecord));
+    }
+    result.append(strings);
+    return result;
+}
+
+// Get async upload status in the fixed binary layout of upload_status_binary.h
+// Alternative to GetAsyncUploadStatusBytes for hosts that should not parse JSON (VB6 in particular)
+// Returns the number of bytes the status needs. The data is copied only if it fits in
+// bufferSize; otherwise nothing is copied and the caller retries with a larger buffer
+// (buffer may be NULL with bufferSize 0 to query the size). Returns 0 on invalid parameters.
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusBinary(
+    const char* dataId,
+    unsigned char* buffer,
+    int bufferSize
+) {
+    // Step 1: Validate parameters
+    if (!dataId || bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        return 0;
+    }
+
+    // Step 2: Collect uploads and build the binary status
+    std::string data;
+    try {
+        unsigned long long version = 0;
+        unsigned long long lastRemovalVersion = 0;
+        auto allUploads = AsyncUploadManager::getInstance().getAllUploadsByDataId(dataId, version, lastRemovalVersion);
+        if (allUploads.empty()) {
+            data = BuildUploadStatusBinary(dataId, allUploads, version, UPLOAD_FAILED,
+                                           formatErrorMessage("No uploads found with dataId"));
+        } else {
+            data = BuildUploadStatusBinary(dataId, allUploads, version, UPLOAD_SUCCESS, "");
+        }
+    } catch (const std::exception& e) {
+        data = BuildUploadStatusBinary(dataId, std::vector<std::shared_ptr<FileUploadTaskInfo>>(), 0, UPLOAD_FAILED,
+                                       formatErrorMessage("Failed to get upload status", e.what()));
+    } catch (...) {
+        data = BuildUploadStatusBinary(dataId, std::vector<std::shared_ptr<FileUploadTaskInfo>>(), 0, UPLOAD_FAILED,
+                                       formatErrorMessage("Failed to get upload status", ErrorMessage::UNKNOWN_ERROR));
+    }
+
+    // Step 3: Copy only complete data
+    int requiredSize = static_cast<int>(data.size());
+    if (requiredSize <= bufferSize) {
+        memcpy(buffer, data.data(), requiredSize);
+    }
+    return requiredSize;
+}
+
+// Split a comma-separated list of dataIds, skipping blanks and duplicates
+static std::vector<std::string> SplitDataIds(const char* dataIds) {
+    std::vector<std::string> result;
+    std::string list(dataIds);
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) {
+            end = list.size();
+        }
+        std::string dataId = list.substr(start, end - start);
+        size_t first = dataId.find_first_not_of(" \t");
+        if (first != std::string::npos) {
+            dataId = dataId.substr(first, dataId.find_last_not_of(" \t") - first + 1);
+            if (std::find(result.begin(), result.end(), dataId) == result.end()) {
+                result.push_back(dataId);
+            }
+        }
+        start = end + 1;
+    }
+    return result;
+}
+
+// Build the batch status JSON
+static void BuildUploadStatusBatchJson(std::string& out, const std::vector<DataIdStatusBatchEntry>& entries, bool includeUploads) {
+    JsonWriter json(out);
+    json.beginObject()
+        .field("code", UPLOAD_SUCCESS)
+        .key("results").beginArray();
+    for (const DataIdStatusBatchEntry& entry : entries) {
+        if (entry.version == 0 || entry.summary.totalUploadCount == 0) {
+            json.beginObject()
+                .field("code", UPLOAD_FAILED)
+                .field("errorMessage", formatErrorMessage("No uploads found with dataId"))
+                .field("dataId", entry.dataId)
+                .endObject();
+            continue;
+        }
+
+        WriteStatusSummaryJson(json, entry.dataId, entry.summary);
+        json.field("version", entry.version);
+        if (includeUploads) {
+            json.key("uploads").beginArray();
+            for (auto& progress : entry.uploads) {
+                WriteUploadEntryJson(json, *progress);
+            }
+            json.endArray();
+        }
+        json.endObject();
+    }
+    json.endArray().endObject();
+}
+
+// Get the status of many dataIds in one call
+// dataIds: comma-separated list of dataIds
+// includeUploads: non-zero to add the per-upload "uploads" array to every result
+// Response: {"code":2,"results":[...]} with one result per distinct dataId, in request order.
+// Each result holds the summary fields of GetAsyncUploadStatusBytes plus "version"
+// (see GetAsyncUploadStatusDelta); unknown dataIds get {"code":3,"errorMessage":...,"dataId":...}.
+// All dataIds are read under a single lock, so the results are mutually consistent.
+// Returns the size of the JSON; the buffer is only filled when it is large enough,
+// so call again with a buffer of the returned size if the result exceeds bufferSize
+extern "C" S3UPLOAD_API int __stdcall GetAsyncUploadStatusBatch(
+    const char* dataIds,
+    int includeUploads,
+    unsigned char* buffer,
+    int bufferSize
+) {
+    // Step 1: Validate parameters
+    if (!dataIds || bufferSize < 0 || (!buffer && bufferSize > 0)) {
+        return 0;
+    }
+
+    // Step 2: Collect the status of every dataId and build the JSON
+    std::string& json = JsonWriter::scratchBuffer();
+    try {
+        auto entries = AsyncUploadManager::getInstance().getStatusBatch(SplitDataIds(dataIds), includeUploads != 0);
+        BuildUploadStatusBatchJson(json, entries, includeUploads != 0);
+    } catch (const std::exception& e) {
+        json = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", e.what()));
+    } catch (...) {
+        json = create_response(UPLOAD_FAILED, formatErrorMessage("Failed to get upload status", ErrorMessage::UNKNOWN_ERROR));
+    }
+
+    // Step 3: Copy only complete data
+    int requiredSize = static_cast<int>(json.size());
+    if (requiredSize <= bufferSize) {
+        memcpy(buffer, json.data(), requiredSize);
+    }
+    return requiredSize;
+}
@@ -17,6 +17,7 @@ Public Enum UploadStatus
     SDK_CLEAN_SUCCESS = 6
     CONFIRM_SUCCESS = 7
     CONFIRM_FAILED = 8
+    UPLOAD_QUEUED_DEFERRED = 9
 End Enum
 
 ' Keep in sync with C++ enum FileOperationType
@@ -130,7 +131,8 @@ Public Function UploadSingleFile(ByVal filePath As String, ByVal s3FileKey As St
     Dim startCode As Long
     startCode = startObj("code")
 
-    If startCode <> UPLOAD_SUCCESS Then
+    ' UPLOAD_QUEUED_DEFERRED means accepted and parked until upload budget frees up
+    If startCode <> UPLOAD_SUCCESS And startCode <> UPLOAD_QUEUED_DEFERRED Then
         Debug.Print "ERROR: Failed to start async upload - " & startObj("message")
         UploadSingleFile = False
         Exit Function
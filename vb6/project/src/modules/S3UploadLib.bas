@@ -42,3 +42,329 @@ Declare Function GetAsyncUploadStatusBytes Lib "S3UploadLib.dll" ( _
     ByVal bufferSize As Long _
 ) As Long
 
+
+' Start asynchronous upload to S3 and return a compact upload handle
+' Upload handles are 64-bit integers; VB6 has no 64-bit integer type, so they are
+' carried in a Currency variable. Treat the value as opaque and pass it back unchanged.
+' Return value: upload handle (non-zero) on success, 0 on failure
+Declare Function UploadFileAsyncHandle Lib "S3UploadLib.dll" ( _
+    ByVal region As String, _
+    ByVal bucketName As String, _
+    ByVal objectKey As String, _
+    ByVal localFilePath As String, _
+    ByVal dataId As String, _
+    ByVal patientId As String, _
+    ByVal fileOperationType As Long _
+) As Currency
+
+' Get the status of a single upload by handle
+' Return value: UploadStatus value, -1 if the handle is unknown or stale
+Declare Function GetUploadStatusByHandle Lib "S3UploadLib.dll" ( _
+    ByVal handle As Currency _
+) As Long
+
+' Request cancellation of a queued or running upload
+' Return value: 1 if cancellation was requested, 0 if unknown or already finished
+Declare Function CancelAsyncUpload Lib "S3UploadLib.dll" ( _
+    ByVal uploadId As String _
+) As Long
+
+' Request cancellation of a queued or running upload by handle
+' Return value: 1 if cancellation was requested, 0 if unknown or already finished
+Declare Function CancelAsyncUploadByHandle Lib "S3UploadLib.dll" ( _
+    ByVal handle As Currency _
+) As Long
+
+' Configure upload admission control (budget of queued and transferring uploads)
+' Parameters:
+'   highWatermarkMB / lowWatermarkMB: stop admitting above the high mark, resume at the low mark
+'   highWatermarkTasks / lowWatermarkTasks: same for the number of uploads
+'   policy: 0 = reject, 1 = block up to blockTimeoutMs, 2 = accept as UPLOAD_QUEUED_DEFERRED
+' Return value: 1 on success, 0 if the parameters are invalid
+Declare Function ConfigureUploadAdmission Lib "S3UploadLib.dll" ( _
+    ByVal highWatermarkMB As Long, _
+    ByVal lowWatermarkMB As Long, _
+    ByVal highWatermarkTasks As Long, _
+    ByVal lowWatermarkTasks As Long, _
+    ByVal policy As Long, _
+    ByVal blockTimeoutMs As Long _
+) As Long
+
+' Enable the upload journal so queued uploads survive a crash or restart
+' Parameters:
+'   directory: folder for upload_journal.log (empty string disables the journal)
+' Unfinished uploads from a previous run are re-enqueued with their original uploadId
+' once SetCredential has been called
+' Return value: 1 on success, 0 if the journal file cannot be opened
+Declare Function EnableUploadJournal Lib "S3UploadLib.dll" ( _
+    ByVal directory As String _
+) As Long
+
+' Get only the uploads of a dataId that changed after sinceVersion
+' Parameters:
+'   dataId: Data ID used to identify the upload
+'   sinceVersion: "version" from the previous response (0 = full list)
+'                 Currency is a scaled 64-bit integer, so pass CCur(version) / 10000
+'   buffer: First byte of the receiving array
+'   bufferSize: Size of the buffer (0 to query the required size)
+' The JSON has the summary fields of GetAsyncUploadStatusBytes plus "version" and
+' "full" (true when "uploads" lists every upload rather than just the changed ones)
+' Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+' (if it did not fit, call again with the same sinceVersion and a larger buffer)
+Declare Function GetAsyncUploadStatusDelta Lib "S3UploadLib.dll" ( _
+    ByVal dataId As String, _
+    ByVal sinceVersion As Currency, _
+    ByRef buffer As Byte, _
+    ByVal bufferSize As Long _
+) As Long
+
+' Block until an upload of a dataId changes state, all of its uploads are finished,
+' or the timeout elapses (long-poll alternative to polling GetAsyncUploadStatusBytes)
+' Parameters:
+'   dataId: Data ID used to identify the upload
+'   sinceVersion: newVersion from the previous call (0 = return the current version immediately)
+'   timeoutMs: Maximum time to wait in milliseconds
+'   newVersion: Receives the current status version (Currency holds the 64-bit value, pass it back unchanged)
+' Note: the call blocks the calling thread - avoid long timeouts on the UI thread
+' Return value: 1 = changed, 2 = all uploads finished, 0 = timeout, -1 = unknown dataId
+Declare Function WaitForUploadStatusChange Lib "S3UploadLib.dll" ( _
+    ByVal dataId As String, _
+    ByVal sinceVersion As Currency, _
+    ByVal timeoutMs As Long, _
+    ByRef newVersion As Currency _
+) As Long
+
+' Register a window that receives upload notifications (hwnd = 0 to unregister)
+' The library posts message with wParam = notification type (0 = state change,
+' 1 = progress milestone) and lParam = UploadStatus; handle it by subclassing the window.
+' Callbacks (RegisterUploadCallback) run on a separate thread and must not be used from VB6.
+' Return value: 1
+Declare Function RegisterUploadWindowMessage Lib "S3UploadLib.dll" ( _
+    ByVal hwnd As Long, _
+    ByVal message As Long _
+) As Long
+
+' Register an event handle (CreateEvent) that is set for every upload notification
+' (0 to unregister); the library keeps its own duplicate of the handle
+' Return value: 1 on success, 0 if the handle is invalid
+Declare Function RegisterUploadEvent Lib "S3UploadLib.dll" ( _
+    ByVal eventHandle As Long _
+) As Long
+
+' Group header of the binary status format (96 bytes)
+' 64-bit values are carried in Currency fields (value / 10000)
+' Strings are NUL-terminated at stringTableOffset + the given offset
+Public Type UploadStatusBinaryHeader
+    magic As Long
+    formatVersion As Integer
+    headerSize As Integer
+    recordSize As Long
+    code As Long
+    overallStatus As Long
+    uploadCount As Long
+    uploadedCount As Long
+    stringTableOffset As Long
+    stringTableSize As Long
+    dataIdOffset As Long
+    errorMessageOffset As Long
+    reserved As Long
+    uploadedSize As Currency
+    totalSize As Currency
+    statusVersion As Currency
+    bytesSent As Currency           ' formatVersion >= 2
+    bytesPerSecond As Currency
+    etaSeconds As Currency          ' -1 = unknown
+End Type
+
+' Per-upload record of the binary status format (88 bytes)
+' flags: 1 = coalesced into an earlier REAL_TIME_APPEND upload
+Public Type UploadStatusBinaryRecord
+    status As Long
+    flags As Long
+    totalSize As Currency
+    startTimeMs As Currency
+    endTimeMs As Currency
+    statusVersion As Currency
+    handle As Currency
+    uploadIdOffset As Long
+    localFilePathOffset As Long
+    s3ObjectKeyOffset As Long
+    errorMessageOffset As Long
+    bytesSent As Currency           ' formatVersion >= 2
+    bytesPerSecond As Currency
+    etaSeconds As Currency          ' -1 = unknown
+End Type
+
+' Get upload status as a header, fixed-size records and a string table (no JSON parsing)
+' Copy the header and records out of the buffer with RtlMoveMemory (CopyMemory);
+' records start at headerSize and are recordSize bytes apart
+' Parameters:
+'   dataId: Data ID used to identify the upload
+'   buffer: First byte of the receiving array
+'   bufferSize: Size of the buffer (0 to query the required size)
+' Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+Declare Function GetAsyncUploadStatusBinary Lib "S3UploadLib.dll" ( _
+    ByVal dataId As String, _
+    ByRef buffer As Byte, _
+    ByVal bufferSize As Long _
+) As Long
+
+' Get the status of many dataIds in one call
+' Response: {"code":2,"results":[...]} with one status object per dataId, in request order
+' Parameters:
+'   dataIds: Comma-separated list of data IDs
+'   includeUploads: Non-zero to include the per-upload list of every dataId
+'   buffer: First byte of the receiving array
+'   bufferSize: Size of the buffer (0 to query the required size)
+' Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+Declare Function GetAsyncUploadStatusBatch Lib "S3UploadLib.dll" ( _
+    ByVal dataIds As String, _
+    ByVal includeUploads As Long, _
+    ByRef buffer As Byte, _
+    ByVal bufferSize As Long _
+) As Long
+
+' Get the buffer size GetAsyncUploadStatusBytes needs for the complete status JSON
+' Parameters:
+'   dataId: Data ID used to identify the upload
+' Return value: Number of bytes required, 0 on error
+Declare Function GetAsyncUploadStatusRequiredSize Lib "S3UploadLib.dll" ( _
+    ByVal dataId As String _
+) As Long
+
+' Get one page of the upload status of a dataId (valid JSON per page)
+' Response: summary fields plus "version", "membershipVersion", "offset", "limit", "nextOffset" (-1 after the last page) and "uploads"
+' Restart paging at offset 0 if "membershipVersion" differs between pages (uploads were added or removed)
+' Parameters:
+'   dataId: Data ID used to identify the upload
+'   offset: Index of the first upload to return
+'   limit: Maximum number of uploads to return (0 for all remaining)
+'   buffer: First byte of the receiving array
+'   bufferSize: Size of the buffer (0 to query the required size)
+' Return value: Number of bytes required; data is copied only if it fits, 0 on invalid parameters
+Declare Function GetAsyncUploadStatusPage Lib "S3UploadLib.dll" ( _
+    ByVal dataId As String, _
+    ByVal offset As Long, _
+    ByVal limit As Long, _
+    ByRef buffer As Byte, _
+    ByVal bufferSize As Long _
+) As Long
+
+' Header of the shared-memory status board (64 bytes)
+' 64-bit values are carried in Currency fields (value / 10000)
+Public Type UploadStatusBoardHeader
+    magic As Long
+    formatVersion As Integer
+    headerSize As Integer
+    slotSize As Long
+    slotCount As Long
+    ownerProcessId As Long
+    state As Long                   ' 0 = closed, 1 = active
+    sequence As Long                ' Changes after every update
+    usedSlots As Long
+    droppedUploads As Long
+    reserved As Long
+    updateTimeMs As Currency        ' Unix epoch milliseconds
+    reserved2 As Currency
+    reserved3 As Currency
+End Type
+
+' One upload slot of the shared-memory status board (320 bytes)
+' inUse: 0 = free slot; strings are NUL-terminated
+Public Type UploadStatusBoardSlot
+    sequence As Long
+    inUse As Long
+    status As Long
+    flags As Long
+    handle As Currency
+    totalSize As Currency
+    bytesSent As Currency
+    bytesPerSecond As Currency
+    etaSeconds As Currency          ' -1 = unknown
+    statusVersion As Currency
+    updateTimeMs As Currency        ' Unix epoch milliseconds
+    uploadId(0 To 79) As Byte
+    dataId(0 To 63) As Byte
+    fileName(0 To 103) As Byte
+End Type
+
+' Publish upload status to a named shared-memory board for other processes
+' Parameters:
+'   name: Mapping name (vbNullString for "Local\HippoUploadStatusBoard")
+'   slotCount: Number of upload slots (0 for 1024)
+' Return value: 1 on success, 0 if the board cannot be created
+Declare Function EnableUploadStatusBoard Lib "S3UploadLib.dll" ( _
+    ByVal name As String, _
+    ByVal slotCount As Long _
+) As Long
+
+' Stop publishing to the status board
+' Return value: 1
+Declare Function DisableUploadStatusBoard Lib "S3UploadLib.dll" () As Long
+
+' Copy a status board published by this or another process
+' Copy the header and slots out of the buffer with RtlMoveMemory (CopyMemory);
+' slots start at headerSize and are slotSize bytes apart
+' Parameters:
+'   name: Mapping name (vbNullString for the default name)
+'   buffer: First byte of the receiving array
+'   bufferSize: Size of the buffer (0 to query the required size)
+' Return value: Number of bytes required; data is copied only if it fits, 0 if no board exists
+Declare Function ReadUploadStatusBoard Lib "S3UploadLib.dll" ( _
+    ByVal name As String, _
+    ByRef buffer As Byte, _
+    ByVal bufferSize As Long _
+) As Long
+
+' Configure background renewal of cached S3 credentials
+' Parameters:
+'   lifetimePercent: renew once this percentage of the credential lifetime has passed
+'                    (at the latest 5 minutes before expiry); 0 = renew only when an
+'                    upload finds them about to expire. Default: 75
+' Return value: 1 on success, 0 if lifetimePercent is outside 0..99
+Declare Function ConfigureCredentialRefresh Lib "S3UploadLib.dll" ( _
+    ByVal lifetimePercent As Long _
+) As Long
+
+' Enable the warm-start credential cache
+' The JWT and unexpired S3 credentials are kept on disk, encrypted for the current
+' Windows user and account, so a restarted process skips login and the first
+' credential request per patient. Call before SetCredential
+' Parameters:
+'   directory: folder for the cache files (empty string disables the cache)
+' Return value: 1 on success, 0 if the directory cannot be used
+Declare Function EnableCredentialCache Lib "S3UploadLib.dll" ( _
+    ByVal directory As String _
+) As Long
+
+' Set credentials and initialize AWS SDK without blocking the caller
+' Initialization and login over a warmed-up connection to the Hippo API run in
+' the background. Uploads submitted meanwhile are accepted and start once the
+' credentials are set. Use PrewarmUploadTarget to also warm the S3 client
+' Return type: JSON string, code 0 once initialization has started
+Declare Function SetCredentialAsync Lib "S3UploadLib.dll" ( _
+    ByVal hippoApiUrl As String, _
+    ByVal userName As String, _
+    ByVal password As String _
+) As String
+
+' Wait for the background initialization started by SetCredentialAsync
+' Parameters:
+'   timeoutMs: 0 polls, negative waits indefinitely
+' Return type: JSON string, code 0 while initialization is still running,
+' otherwise the same response as SetCredential
+Declare Function WaitForCredential Lib "S3UploadLib.dll" ( _
+    ByVal timeoutMs As Long _
+) As String
+
+' Prepare the first upload to a bucket ahead of time
+' In the background (once the credentials are set), fetches the patient's S3
+' credentials, creates the S3 client its uploads reuse and opens its connection
+' to the bucket endpoint
+' Return value: 1 if the warm-up was started, 0 on invalid parameters or if
+' neither SetCredential nor SetCredentialAsync was called
+Declare Function PrewarmUploadTarget Lib "S3UploadLib.dll" ( _
+    ByVal region As String, _
+    ByVal bucketName As String, _
+    ByVal patientId As String _
+) As Long